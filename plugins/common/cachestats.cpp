@@ -0,0 +1,169 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "cachestats.h"
+#include "signalnotifier.h"
+
+#include <QDBusConnection>
+#include <QDebug>
+#include <QMutex>
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+#include <signal.h>
+
+namespace Cutefish
+{
+
+namespace
+{
+
+QMutex s_registryMutex;
+QVector<const CacheStats *> s_registry;
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes >= 10 << 20)
+        return QStringLiteral("%1 MiB").arg(bytes >> 20);
+    if (bytes >= 10 << 10)
+        return QStringLiteral("%1 KiB").arg(bytes >> 10);
+    return QStringLiteral("%1 B").arg(bytes);
+}
+
+}
+
+// The D-Bus face of the registry, every call takes a fresh snapshot.
+class CacheStatsAdaptor : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.cutefish.CacheStats")
+
+public slots:
+    QVariantMap caches() const
+    {
+        QVariantMap caches;
+        for (const CacheStats::Snapshot &cache : CacheStats::all()) {
+            caches.insert(cache.name, QVariantMap {
+                { QStringLiteral("entries"), cache.entries },
+                { QStringLiteral("cpuBytes"), cache.cpuBytes },
+                { QStringLiteral("gpuBytes"), cache.gpuBytes },
+                { QStringLiteral("hits"), cache.hits },
+                { QStringLiteral("misses"), cache.misses },
+                { QStringLiteral("evictions"), cache.evictions },
+            });
+        }
+        return caches;
+    }
+
+    QString report() const
+    {
+        return CacheStats::report();
+    }
+};
+
+CacheStats::CacheStats(const QString &name)
+    : m_name(name)
+{
+    QMutexLocker locker(&s_registryMutex);
+    s_registry.append(this);
+}
+
+CacheStats::~CacheStats()
+{
+    QMutexLocker locker(&s_registryMutex);
+    s_registry.removeOne(this);
+}
+
+CacheStats::Snapshot CacheStats::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.name = m_name;
+    snapshot.entries = m_entries.load(std::memory_order_relaxed);
+    snapshot.cpuBytes = m_cpuBytes.load(std::memory_order_relaxed);
+    snapshot.gpuBytes = m_gpuBytes.load(std::memory_order_relaxed);
+    snapshot.hits = m_hits.load(std::memory_order_relaxed);
+    snapshot.misses = m_misses.load(std::memory_order_relaxed);
+    snapshot.evictions = m_evictions.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+QList<CacheStats::Snapshot> CacheStats::all()
+{
+    QList<Snapshot> snapshots;
+
+    QMutexLocker locker(&s_registryMutex);
+    for (const CacheStats *stats : std::as_const(s_registry))
+        snapshots.append(stats->snapshot());
+
+    return snapshots;
+}
+
+QString CacheStats::report()
+{
+    QString report;
+    qint64 cpuBytes = 0;
+    qint64 gpuBytes = 0;
+
+    for (const Snapshot &cache : all()) {
+        const qint64 lookups = cache.hits + cache.misses;
+        const QString hitRate = lookups ? QStringLiteral("%1%").arg(100.0 * cache.hits / lookups, 0, 'f', 1)
+                                        : QStringLiteral("-");
+
+        report += QStringLiteral("%1 %2 entries, %3 cpu, %4 gpu, %5 hits, %6 misses (%7), %8 evictions\n")
+                      .arg(cache.name, -28)
+                      .arg(cache.entries)
+                      .arg(formatBytes(cache.cpuBytes), formatBytes(cache.gpuBytes))
+                      .arg(cache.hits)
+                      .arg(cache.misses)
+                      .arg(hitRate)
+                      .arg(cache.evictions);
+
+        cpuBytes += cache.cpuBytes;
+        gpuBytes += cache.gpuBytes;
+    }
+
+    report += QStringLiteral("total %1 cpu, %2 gpu\n").arg(formatBytes(cpuBytes), formatBytes(gpuBytes));
+    return report;
+}
+
+CacheStats::Exporter::Exporter(const char *category)
+    : m_path(QStringLiteral("/org/cutefish/CacheStats/%1").arg(QString::fromLatin1(category)))
+    , m_adaptor(new CacheStatsAdaptor)
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.registerObject(m_path, m_adaptor.get(), QDBusConnection::ExportAllSlots))
+        m_path.clear();
+
+    if (qEnvironmentVariableIsSet("CUTEFISH_CACHE_STATS")) {
+        m_signal.reset(new SignalNotifier(SIGUSR1, [category] {
+            qInfo().noquote() << "Cutefish caches of" << category << "\n" << CacheStats::report();
+        }));
+    }
+}
+
+CacheStats::Exporter::~Exporter()
+{
+    if (!m_path.isEmpty())
+        QDBusConnection::sessionBus().unregisterObject(m_path);
+}
+
+}
+
+#include "cachestats.moc"
@@ -0,0 +1,107 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CUTEFISH_CACHESTATS_H
+#define CUTEFISH_CACHESTATS_H
+
+#include <QList>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+
+namespace Cutefish
+{
+
+class SignalNotifier;
+class CacheStatsAdaptor;
+
+// Size and effectiveness of one cache of a plugin. The cache owns its
+// CacheStats and reports what it holds after every change; all live
+// instances of the plugin are listed by CacheStats::all().
+//
+// While a CacheStats::Exporter is alive they are published on the
+// session bus as org.cutefish.CacheStats at
+// /org/cutefish/CacheStats/<category>. When CUTEFISH_CACHE_STATS is set
+// in kwin's environment, sending SIGUSR1 to kwin also writes them to the
+// log, for the first plugin that claimed the signal.
+class CacheStats
+{
+public:
+    struct Snapshot {
+        QString name;
+        qint64 entries = 0;
+        qint64 cpuBytes = 0;
+        qint64 gpuBytes = 0;
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+    };
+
+    explicit CacheStats(const QString &name);
+    ~CacheStats();
+
+    CacheStats(const CacheStats &) = delete;
+    CacheStats &operator=(const CacheStats &) = delete;
+
+    void setUsage(qint64 entries, qint64 cpuBytes, qint64 gpuBytes = 0)
+    {
+        m_entries.store(entries, std::memory_order_relaxed);
+        m_cpuBytes.store(cpuBytes, std::memory_order_relaxed);
+        m_gpuBytes.store(gpuBytes, std::memory_order_relaxed);
+    }
+
+    void hit() { m_hits.fetch_add(1, std::memory_order_relaxed); }
+    void miss() { m_misses.fetch_add(1, std::memory_order_relaxed); }
+    void evicted(qint64 count = 1) { m_evictions.fetch_add(count, std::memory_order_relaxed); }
+
+    Snapshot snapshot() const;
+
+    static QList<Snapshot> all();
+    // One line per cache plus the totals, for the log.
+    static QString report();
+
+    class Exporter
+    {
+    public:
+        explicit Exporter(const char *category);
+        ~Exporter();
+
+        Exporter(const Exporter &) = delete;
+        Exporter &operator=(const Exporter &) = delete;
+
+    private:
+        QString m_path;
+        std::unique_ptr<CacheStatsAdaptor> m_adaptor;
+        std::unique_ptr<SignalNotifier> m_signal;
+    };
+
+private:
+    QString m_name;
+    std::atomic<qint64> m_entries{0};
+    std::atomic<qint64> m_cpuBytes{0};
+    std::atomic<qint64> m_gpuBytes{0};
+    std::atomic<qint64> m_hits{0};
+    std::atomic<qint64> m_misses{0};
+    std::atomic<qint64> m_evictions{0};
+};
+
+}
+
+#endif
@@ -0,0 +1,380 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "eventlog.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Cutefish
+{
+
+namespace EventLog
+{
+
+static const char s_magic[4] = { 'C', 'F', 'E', 'V' };
+static const int s_headerSize = 24;
+static const qint64 s_chunkSize = 1 << 20;
+
+static QRect relativeBase(const QRect &geometry)
+{
+    return QRect(geometry.topLeft(), QSize(0, 0));
+}
+
+Writer::~Writer()
+{
+    close();
+}
+
+bool Writer::open(const QString &path)
+{
+    close();
+
+    m_fd = ::open(QFile::encodeName(path).constData(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (m_fd < 0)
+        return false;
+
+    m_path = path;
+    if (!reserve(s_headerSize)) {
+        close();
+        return false;
+    }
+
+    uchar *header = m_data;
+    std::memcpy(header, s_magic, sizeof(s_magic));
+    qToLittleEndian<quint16>(Version, header + 4);
+    qToLittleEndian<quint16>(s_headerSize, header + 6);
+    qToLittleEndian<qint64>(QDateTime::currentMSecsSinceEpoch(), header + 8);
+    qToLittleEndian<quint64>(0, header + 16);
+    m_used = s_headerSize;
+
+    return true;
+}
+
+void Writer::close()
+{
+    if (m_data) {
+        ::munmap(m_data, m_capacity);
+        m_data = nullptr;
+    }
+
+    if (m_fd >= 0) {
+        // Drop the unused tail of the last chunk.
+        if (::ftruncate(m_fd, m_used) < 0) {
+            // The zero bytes behind the last record read as the end.
+        }
+        ::close(m_fd);
+        m_fd = -1;
+    }
+
+    m_capacity = 0;
+    m_used = 0;
+    m_lastTime = 0;
+    m_geometries.clear();
+}
+
+bool Writer::reserve(qint64 bytes)
+{
+    if (m_used + bytes <= m_capacity)
+        return true;
+
+    const qint64 capacity = qMax(m_capacity * 2, m_used + bytes + s_chunkSize);
+
+    if (m_data) {
+        ::munmap(m_data, m_capacity);
+        m_data = nullptr;
+    }
+
+    if (::ftruncate(m_fd, capacity) < 0)
+        return false;
+
+    void *data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+        return false;
+
+    m_data = static_cast<uchar *>(data);
+    m_capacity = capacity;
+    return true;
+}
+
+void Writer::putVarint(quint64 value)
+{
+    while (value >= 0x80) {
+        m_data[m_used++] = uchar(value | 0x80);
+        value >>= 7;
+    }
+    m_data[m_used++] = uchar(value);
+}
+
+void Writer::putSigned(qint64 value)
+{
+    putVarint((quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+void Writer::putRect(const QRect &rect, const QRect &base)
+{
+    putSigned(qint64(rect.x()) - base.x());
+    putSigned(qint64(rect.y()) - base.y());
+    putSigned(qint64(rect.width()) - base.width());
+    putSigned(qint64(rect.height()) - base.height());
+}
+
+// The most bytes a record can take, with every varint at its maximum
+// length.
+static qint64 maxRecordSize(const Event &event, int windowClassSize)
+{
+    const qint64 varint = 10;
+    const qint64 rect = 4 * varint;
+
+    // Type, time and window.
+    qint64 size = 1 + 2 * varint;
+
+    switch (event.type) {
+    case WindowAdded:
+        // Flags, geometry, icon geometry and the class with its length.
+        size += varint + 2 * rect + varint + windowClassSize;
+        break;
+    case WindowMaximized:
+    case Frame:
+        size += varint;
+        break;
+    case WindowGeometry:
+        size += rect;
+        break;
+    case WindowDamaged:
+        size += varint + event.rects.size() * rect;
+        break;
+    default:
+        break;
+    }
+
+    return size;
+}
+
+bool Writer::write(const Event &event)
+{
+    if (!m_data || event.type == End)
+        return false;
+
+    const QByteArray windowClass = event.windowClass.toUtf8();
+
+    if (!reserve(maxRecordSize(event, windowClass.size())))
+        return false;
+
+    m_data[m_used++] = event.type;
+    putVarint(quint64(qMax<qint64>(event.time - m_lastTime, 0)));
+    putVarint(event.window);
+    m_lastTime = qMax(m_lastTime, event.time);
+
+    switch (event.type) {
+    case WindowAdded:
+        putVarint(event.flags);
+        putRect(event.geometry, QRect(0, 0, 0, 0));
+        putRect(event.iconGeometry, event.geometry);
+        putVarint(windowClass.size());
+        std::memcpy(m_data + m_used, windowClass.constData(), windowClass.size());
+        m_used += windowClass.size();
+        m_geometries.insert(event.window, event.geometry);
+        break;
+    case WindowMaximized:
+    case Frame:
+        putVarint(event.value);
+        break;
+    case WindowGeometry:
+        putRect(event.geometry, m_geometries.value(event.window, QRect(0, 0, 0, 0)));
+        m_geometries.insert(event.window, event.geometry);
+        break;
+    case WindowDamaged: {
+        const QRect base = relativeBase(m_geometries.value(event.window));
+        putVarint(event.rects.size());
+        for (const QRect &rect : event.rects)
+            putRect(rect, base);
+        break;
+    }
+    case WindowDeleted:
+        m_geometries.remove(event.window);
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool Reader::open(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_error = file.errorString();
+        return false;
+    }
+
+    return load(file.readAll());
+}
+
+bool Reader::load(const QByteArray &data)
+{
+    m_data = data;
+    m_pos = 0;
+    m_time = 0;
+    m_error.clear();
+    m_geometries.clear();
+
+    if (m_data.size() < s_headerSize || std::memcmp(m_data.constData(), s_magic, sizeof(s_magic)) != 0) {
+        m_error = QStringLiteral("not a window event capture");
+        return false;
+    }
+
+    const uchar *header = reinterpret_cast<const uchar *>(m_data.constData());
+    const quint16 version = qFromLittleEndian<quint16>(header + 4);
+    const quint16 headerSize = qFromLittleEndian<quint16>(header + 6);
+
+    if (version > Version || headerSize < s_headerSize || headerSize > m_data.size()) {
+        m_error = QStringLiteral("unsupported capture version %1").arg(version);
+        return false;
+    }
+
+    m_startTime = qFromLittleEndian<qint64>(header + 8);
+    m_pos = headerSize;
+    return true;
+}
+
+bool Reader::getVarint(quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_pos >= m_data.size())
+            return false;
+
+        const uchar byte = uchar(m_data.at(m_pos++));
+        value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool Reader::getSigned(qint64 &value)
+{
+    quint64 encoded;
+    if (!getVarint(encoded))
+        return false;
+
+    value = qint64(encoded >> 1) ^ -qint64(encoded & 1);
+    return true;
+}
+
+bool Reader::getRect(QRect &rect, const QRect &base)
+{
+    qint64 x, y, width, height;
+    if (!getSigned(x) || !getSigned(y) || !getSigned(width) || !getSigned(height))
+        return false;
+
+    rect = QRect(base.x() + x, base.y() + y, base.width() + width, base.height() + height);
+    return true;
+}
+
+bool Reader::next(Event &event)
+{
+    if (m_pos >= m_data.size())
+        return false;
+
+    const quint8 type = quint8(m_data.at(m_pos++));
+    if (type == End)
+        return false;
+
+    if (type > Frame) {
+        m_error = QStringLiteral("unknown record type %1 at offset %2").arg(type).arg(m_pos - 1);
+        return false;
+    }
+
+    event = Event();
+    event.type = Type(type);
+
+    quint64 delta, window;
+    if (!getVarint(delta) || !getVarint(window)) {
+        m_error = QStringLiteral("truncated record at offset %1").arg(m_pos);
+        return false;
+    }
+
+    m_time += delta;
+    event.time = m_time;
+    event.window = quint32(window);
+
+    bool ok = true;
+    quint64 value = 0;
+
+    switch (event.type) {
+    case WindowAdded: {
+        quint64 length = 0;
+        ok = getVarint(value) && getRect(event.geometry, QRect(0, 0, 0, 0))
+            && getRect(event.iconGeometry, event.geometry) && getVarint(length)
+            && length <= quint64(m_data.size() - m_pos);
+        if (ok) {
+            event.flags = quint32(value);
+            event.windowClass = QString::fromUtf8(m_data.constData() + m_pos, int(length));
+            m_pos += int(length);
+            m_geometries.insert(event.window, event.geometry);
+        }
+        break;
+    }
+    case WindowMaximized:
+    case Frame:
+        ok = getVarint(event.value);
+        break;
+    case WindowGeometry:
+        ok = getRect(event.geometry, m_geometries.value(event.window, QRect(0, 0, 0, 0)));
+        if (ok)
+            m_geometries.insert(event.window, event.geometry);
+        break;
+    case WindowDamaged: {
+        const QRect base = relativeBase(m_geometries.value(event.window));
+        ok = getVarint(value) && value <= quint64(m_data.size() - m_pos);
+        for (quint64 i = 0; ok && i < value; ++i) {
+            QRect rect;
+            ok = getRect(rect, base);
+            event.rects.append(rect);
+        }
+        break;
+    }
+    case WindowDeleted:
+        m_geometries.remove(event.window);
+        break;
+    default:
+        break;
+    }
+
+    if (!ok) {
+        m_error = QStringLiteral("truncated record at offset %1").arg(m_pos);
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+}
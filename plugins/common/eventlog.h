@@ -0,0 +1,162 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CUTEFISH_EVENTLOG_H
+#define CUTEFISH_EVENTLOG_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+namespace Cutefish
+{
+
+// Window event captures written by the recorder effect.
+//
+// A 24 byte header ("CFEV", version, start time) is followed by records
+// of a type byte, the time since the previous record in microseconds,
+// a capture-local window id and a type specific payload. Integers are
+// LEB128 varints, signed ones zigzag encoded; geometries are stored as
+// the difference to the window's previous geometry. A zero type byte
+// ends the capture, so a file cut short by a crash is still readable.
+namespace EventLog
+{
+
+static const quint16 Version = 1;
+
+enum Type : quint8 {
+    End = 0,
+    WindowAdded = 1,      // flags, geometry, icon geometry, window class
+    WindowClosed = 2,
+    WindowDeleted = 3,
+    WindowMinimized = 4,
+    WindowUnminimized = 5,
+    WindowMaximized = 6,  // value: MaximizedHorizontally | MaximizedVertically
+    WindowGeometry = 7,   // geometry
+    WindowDamaged = 8,    // rects, relative to the window
+    Frame = 9             // value: us since the previous frame was presented, window: painted windows
+};
+
+enum WindowFlag : quint32 {
+    Normal = 1 << 0,
+    Dialog = 1 << 1,
+    Transient = 1 << 2,
+    Popup = 1 << 3,
+    PopupMenu = 1 << 4,
+    DropdownMenu = 1 << 5,
+    ComboBox = 1 << 6,
+    Tooltip = 1 << 7,
+    Notification = 1 << 8,
+    CriticalNotification = 1 << 9,
+    OnScreenDisplay = 1 << 10,
+    Dock = 1 << 11,
+    Splash = 1 << 12,
+    Toolbar = 1 << 13,
+    Utility = 1 << 14,
+    Outline = 1 << 15,
+    Managed = 1 << 16,
+    Decorated = 1 << 17,
+    X11Client = 1 << 18
+};
+
+enum MaximizeFlag : quint32 {
+    MaximizedHorizontally = 1 << 0,
+    MaximizedVertically = 1 << 1
+};
+
+struct Event {
+    Type type = End;
+    qint64 time = 0;   // us since the start of the capture
+    quint32 window = 0;
+    quint32 flags = 0;
+    quint64 value = 0;
+    QRect geometry;
+    QRect iconGeometry;
+    QVector<QRect> rects;
+    QString windowClass;
+};
+
+// Appends to a memory mapped file, growing it in chunks.
+class Writer
+{
+public:
+    Writer() = default;
+    ~Writer();
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    QString path() const { return m_path; }
+    qint64 size() const { return m_used; }
+
+    // Events must be written in time order.
+    bool write(const Event &event);
+
+private:
+    bool reserve(qint64 bytes);
+    void putVarint(quint64 value);
+    void putSigned(qint64 value);
+    void putRect(const QRect &rect, const QRect &base);
+
+    QString m_path;
+    int m_fd = -1;
+    uchar *m_data = nullptr;
+    qint64 m_capacity = 0;
+    qint64 m_used = 0;
+    qint64 m_lastTime = 0;
+    QHash<quint32, QRect> m_geometries;
+};
+
+class Reader
+{
+public:
+    bool open(const QString &path);
+    bool load(const QByteArray &data);
+
+    QString errorString() const { return m_error; }
+    qint64 startTime() const { return m_startTime; }
+
+    // False at the end of the capture or on a malformed record, see
+    // errorString() for the latter.
+    bool next(Event &event);
+
+private:
+    bool getVarint(quint64 &value);
+    bool getSigned(qint64 &value);
+    bool getRect(QRect &rect, const QRect &base);
+
+    QByteArray m_data;
+    int m_pos = 0;
+    qint64 m_time = 0;
+    qint64 m_startTime = 0;
+    QString m_error;
+    QHash<quint32, QRect> m_geometries;
+};
+
+}
+
+}
+
+#endif
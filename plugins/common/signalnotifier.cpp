@@ -0,0 +1,119 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "signalnotifier.h"
+
+#include <QDebug>
+#include <QSocketNotifier>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+namespace Cutefish
+{
+
+namespace
+{
+
+struct Slot {
+    int pipe[2] = { -1, -1 };
+    struct sigaction previousAction;
+};
+
+Slot s_slots[NSIG];
+
+void handleSignal(int signo)
+{
+    const char c = 1;
+    if (::write(s_slots[signo].pipe[1], &c, 1) < 0) {
+        // Nothing we can do in a signal handler.
+    }
+}
+
+bool isHandled(int signo)
+{
+    struct sigaction current;
+    if (sigaction(signo, nullptr, &current) < 0)
+        return true;
+
+    if (current.sa_flags & SA_SIGINFO)
+        return current.sa_sigaction != nullptr;
+
+    return current.sa_handler != SIG_DFL && current.sa_handler != SIG_IGN;
+}
+
+}
+
+SignalNotifier::SignalNotifier(int signo, std::function<void()> callback)
+    : m_signo(signo)
+    , m_callback(std::move(callback))
+{
+    if (signo <= 0 || signo >= NSIG)
+        return;
+
+    // Another notifier, in this plugin or another one, or kwin itself
+    // already handles it.
+    Slot &slot = s_slots[signo];
+    if (slot.pipe[0] >= 0 || isHandled(signo))
+        return;
+
+    if (::pipe2(slot.pipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        qWarning() << "Cutefish: cannot create a pipe for signal" << signo;
+        slot.pipe[0] = slot.pipe[1] = -1;
+        return;
+    }
+
+    m_notifier.reset(new QSocketNotifier(slot.pipe[0], QSocketNotifier::Read));
+    QObject::connect(m_notifier.get(), &QSocketNotifier::activated, [this, &slot] {
+        char buffer[16];
+        while (::read(slot.pipe[0], buffer, sizeof(buffer)) > 0) {
+        }
+
+        m_callback();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = handleSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(signo, &action, &slot.previousAction);
+}
+
+SignalNotifier::~SignalNotifier()
+{
+    if (!m_notifier)
+        return;
+
+    Slot &slot = s_slots[m_signo];
+
+    // Don't leave a dangling handler behind when the plugin is unloaded.
+    struct sigaction current;
+    sigaction(m_signo, nullptr, &current);
+    if (current.sa_handler == handleSignal)
+        sigaction(m_signo, &slot.previousAction, nullptr);
+
+    m_notifier.reset();
+
+    ::close(slot.pipe[0]);
+    ::close(slot.pipe[1]);
+    slot.pipe[0] = slot.pipe[1] = -1;
+}
+
+}
@@ -0,0 +1,58 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CUTEFISH_SIGNALNOTIFIER_H
+#define CUTEFISH_SIGNALNOTIFIER_H
+
+#include <functional>
+#include <memory>
+
+class QSocketNotifier;
+
+namespace Cutefish
+{
+
+// Runs a callback in the event loop whenever the process receives a
+// signal, through a self-pipe.
+//
+// Every plugin links its own copy of this file, so a handler can't tell
+// whether the one it replaced lives in a library that is still loaded.
+// Only the first notifier in the whole process takes a signal; while any
+// handler is installed the others stay inactive, see isActive(). The
+// default action is put back on destruction.
+class SignalNotifier
+{
+public:
+    SignalNotifier(int signo, std::function<void()> callback);
+    ~SignalNotifier();
+
+    SignalNotifier(const SignalNotifier &) = delete;
+    SignalNotifier &operator=(const SignalNotifier &) = delete;
+
+    bool isActive() const { return m_notifier != nullptr; }
+
+private:
+    int m_signo;
+    std::function<void()> m_callback;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+};
+
+}
+
+#endif
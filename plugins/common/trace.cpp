@@ -0,0 +1,287 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "trace.h"
+#include "signalnotifier.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMutex>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <atomic>
+#include <chrono>
+
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Cutefish
+{
+
+namespace Trace
+{
+
+const bool s_enabled = qEnvironmentVariableIsSet("CUTEFISH_TRACE");
+
+namespace
+{
+
+struct Event {
+    const char *name;
+    qint64 begin;
+    qint64 end;
+};
+
+// One entry of the ring, a seqlock: stamp is the index of the event it
+// holds plus one, and 0 while the thread rewrites it.
+struct Slot {
+    std::atomic<quint64> stamp{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> begin{0};
+    std::atomic<qint64> end{0};
+};
+
+// Written only by its own thread, without locking. A dump keeps an entry
+// only if its stamp is the expected one before and after copying it, so
+// entries the thread overwrites meanwhile are dropped rather than torn.
+struct ThreadBuffer {
+    static const quint64 Capacity = 1 << 13;
+
+    Slot slots[Capacity];
+    std::atomic<quint64> head{0};
+    int tid = 0;
+};
+
+// Buffers are kept after their thread exits, so its spans can still be
+// dumped. Only touched once per thread and on dump.
+QMutex s_buffersMutex;
+QVector<ThreadBuffer *> s_buffers;
+
+thread_local ThreadBuffer *t_buffer = nullptr;
+
+ThreadBuffer *threadBuffer()
+{
+    if (!t_buffer) {
+        t_buffer = new ThreadBuffer;
+        // The kernel's id, so that the spans other plugins record on the
+        // same thread end up on the same track.
+        t_buffer->tid = int(::syscall(SYS_gettid));
+
+        QMutexLocker locker(&s_buffersMutex);
+        s_buffers.append(t_buffer);
+    }
+
+    return t_buffer;
+}
+
+// Appends the spans recorded by this copy of the file.
+void collect(const char *category, QByteArray *json, bool *first)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QMutexLocker locker(&s_buffersMutex);
+
+    for (const ThreadBuffer *buffer : std::as_const(s_buffers)) {
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        const quint64 begin = head > ThreadBuffer::Capacity ? head - ThreadBuffer::Capacity : 0;
+
+        QVector<Event> events;
+        events.reserve(head - begin);
+        for (quint64 i = begin; i < head; ++i) {
+            const Slot &slot = buffer->slots[i & (ThreadBuffer::Capacity - 1)];
+
+            const quint64 stamp = slot.stamp.load(std::memory_order_acquire);
+            const Event event = { slot.name.load(std::memory_order_relaxed),
+                                  slot.begin.load(std::memory_order_relaxed),
+                                  slot.end.load(std::memory_order_relaxed) };
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            // Overwritten by a newer event, or being overwritten.
+            if (stamp != i + 1 || slot.stamp.load(std::memory_order_relaxed) != stamp)
+                continue;
+
+            events.append(event);
+        }
+
+        for (const Event &event : std::as_const(events)) {
+            if (!*first)
+                *json += ",\n";
+            *first = false;
+
+            *json += QByteArrayLiteral("{\"name\":\"") + event.name
+                   + QByteArrayLiteral("\",\"cat\":\"") + category
+                   + QByteArrayLiteral("\",\"ph\":\"X\",\"ts\":") + QByteArray::number(event.begin / 1000.0, 'f', 3)
+                   + QByteArrayLiteral(",\"dur\":") + QByteArray::number((event.end - event.begin) / 1000.0, 'f', 3)
+                   + QByteArrayLiteral(",\"pid\":") + QByteArray::number(pid)
+                   + QByteArrayLiteral(",\"tid\":") + QByteArray::number(buffer->tid) + '}';
+        }
+    }
+}
+
+// Every plugin links its own copy of this file, and with it its own
+// buffers. The dumpers of all of them are listed in a property of the
+// application, so the one that holds SIGUSR2 writes the spans of every
+// plugin into the same file, and another one takes the signal over when
+// it goes away. Only plain pointers cross between the copies.
+const char s_sourcesProperty[] = "_cutefish_trace_sources";
+const char s_dumpCountProperty[] = "_cutefish_trace_dumps";
+
+QList<Source *> sources()
+{
+    QList<Source *> result;
+    if (!qApp)
+        return result;
+
+    const QVariantList list = qApp->property(s_sourcesProperty).toList();
+    for (const QVariant &source : list)
+        result.append(reinterpret_cast<Source *>(source.toULongLong()));
+
+    return result;
+}
+
+void setSources(const QList<Source *> &list)
+{
+    if (!qApp)
+        return;
+
+    QVariantList property;
+    for (Source *source : list)
+        property.append(qulonglong(reinterpret_cast<quintptr>(source)));
+
+    qApp->setProperty(s_sourcesProperty, property);
+}
+
+}
+
+struct Source {
+    const char *category;
+    Dumper *dumper;
+    void (*collect)(const char *category, QByteArray *json, bool *first);
+    void (*claim)(Dumper *dumper);
+};
+
+qint64 now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record(const char *name, qint64 begin, qint64 end)
+{
+    ThreadBuffer *buffer = threadBuffer();
+
+    const quint64 head = buffer->head.load(std::memory_order_relaxed);
+    Slot &slot = buffer->slots[head & (ThreadBuffer::Capacity - 1)];
+
+    slot.stamp.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.begin.store(begin, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.stamp.store(head + 1, std::memory_order_release);
+
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+Dumper::Dumper(const char *category)
+{
+    if (!s_enabled)
+        return;
+
+    m_source.reset(new Source{ category, this, collect, [](Dumper *dumper) { dumper->claim(); } });
+    setSources(sources() << m_source.get());
+    claim();
+}
+
+Dumper::~Dumper()
+{
+    if (!m_source)
+        return;
+
+    QList<Source *> list = sources();
+    list.removeAll(m_source.get());
+    setSources(list);
+
+    // Put the default action back first, so that the next one finds the
+    // signal free.
+    const bool owner = m_signal && m_signal->isActive();
+    m_signal.reset();
+
+    if (owner && !list.isEmpty())
+        list.first()->claim(list.first()->dumper);
+}
+
+void Dumper::claim()
+{
+    if (m_signal && m_signal->isActive())
+        return;
+
+    m_signal.reset(new SignalNotifier(SIGUSR2, [this] { dump(); }));
+}
+
+bool Dumper::dump() const
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty())
+        dir = QStringLiteral("/tmp");
+
+    const int dumpCount = qApp->property(s_dumpCountProperty).toInt() + 1;
+    qApp->setProperty(s_dumpCountProperty, dumpCount);
+
+    const QString fileName = QStringLiteral("%1/cutefish-trace-%2-%3.json")
+                                 .arg(dir)
+                                 .arg(QCoreApplication::applicationPid())
+                                 .arg(dumpCount);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cutefish trace: cannot write" << fileName;
+        return false;
+    }
+
+    QByteArray json("{\"traceEvents\":[\n");
+    bool first = true;
+
+    // Each copy of the buffers once, even if it has several dumpers.
+    QList<void (*)(const char *, QByteArray *, bool *)> collected;
+    for (const Source *source : sources()) {
+        if (collected.contains(source->collect))
+            continue;
+
+        collected.append(source->collect);
+        source->collect(source->category, &json, &first);
+    }
+
+    json += "\n]}\n";
+
+    if (file.write(json) != json.size()) {
+        qWarning() << "Cutefish trace: short write to" << fileName;
+        return false;
+    }
+
+    qDebug() << "Cutefish trace: wrote" << fileName;
+    return true;
+}
+
+}
+
+}
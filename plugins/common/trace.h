@@ -0,0 +1,112 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CUTEFISH_TRACE_H
+#define CUTEFISH_TRACE_H
+
+#include <QtGlobal>
+
+#include <memory>
+
+// Scoped timing spans for the paint paths.
+//
+// Built in unless configured with -DCUTEFISH_TRACING=OFF, recorded only
+// when CUTEFISH_TRACE is set in kwin's environment. Spans go into a
+// per-thread ring buffer, sending SIGUSR2 to kwin writes those of every
+// plugin as Chrome trace events (loadable in chrome://tracing and
+// ui.perfetto.dev) to $XDG_RUNTIME_DIR/cutefish-trace-<pid>-<n>.json,
+// with the plugin as their category.
+//
+// Span names must be string literals, they are stored by pointer.
+
+#ifdef CUTEFISH_TRACING
+#define CUTEFISH_TRACE_CONCAT_(a, b) a##b
+#define CUTEFISH_TRACE_CONCAT(a, b) CUTEFISH_TRACE_CONCAT_(a, b)
+#define CUTEFISH_TRACE_SCOPE(name) \
+    const Cutefish::Trace::Span CUTEFISH_TRACE_CONCAT(cutefishTraceSpan, __LINE__)(name)
+#else
+#define CUTEFISH_TRACE_SCOPE(name) do { } while (false)
+#endif
+
+namespace Cutefish
+{
+
+class SignalNotifier;
+
+namespace Trace
+{
+
+extern const bool s_enabled;
+
+inline bool enabled() { return s_enabled; }
+
+qint64 now();
+void record(const char *name, qint64 begin, qint64 end);
+
+class Span
+{
+public:
+    explicit Span(const char *name)
+        : m_name(s_enabled ? name : nullptr)
+        , m_begin(m_name ? now() : 0)
+    {
+    }
+
+    ~Span()
+    {
+        if (m_name)
+            record(m_name, m_begin, now());
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_begin;
+};
+
+struct Source;
+
+// Makes the spans recorded by this plugin part of the dump while alive.
+// Does nothing unless tracing is enabled. One dumper in the process
+// holds SIGUSR2 and writes the spans of all of them.
+class Dumper
+{
+public:
+    explicit Dumper(const char *category);
+    ~Dumper();
+
+    Dumper(const Dumper &) = delete;
+    Dumper &operator=(const Dumper &) = delete;
+
+    bool dump() const;
+
+private:
+    void claim();
+
+    std::unique_ptr<Source> m_source;
+    std::unique_ptr<SignalNotifier> m_signal;
+};
+
+}
+
+}
+
+#endif
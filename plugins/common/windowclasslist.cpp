@@ -0,0 +1,76 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "windowclasslist.h"
+
+#include <KConfigGroup>
+
+#include <QDebug>
+
+namespace Cutefish
+{
+
+WindowClassList::WindowClassList(const QStringList &entries)
+{
+    setEntries(entries);
+}
+
+void WindowClassList::load(const KConfigGroup &group, const char *key, const QStringList &defaults)
+{
+    setEntries(group.readEntry(key, defaults));
+}
+
+void WindowClassList::setEntries(const QStringList &entries)
+{
+    m_exact.clear();
+    m_patterns.clear();
+
+    for (const QString &entry : entries) {
+        const QString trimmed = entry.trimmed();
+        if (trimmed.isEmpty())
+            continue;
+
+        if (trimmed.size() > 2 && trimmed.startsWith(QLatin1Char('/')) && trimmed.endsWith(QLatin1Char('/'))) {
+            QRegularExpression pattern(trimmed.mid(1, trimmed.size() - 2));
+            if (!pattern.isValid()) {
+                qWarning() << "Ignoring invalid window class pattern" << trimmed << pattern.errorString();
+                continue;
+            }
+            pattern.optimize();
+            m_patterns.append(pattern);
+        } else {
+            m_exact.insert(trimmed);
+        }
+    }
+}
+
+bool WindowClassList::contains(const QString &windowClass) const
+{
+    if (m_exact.contains(windowClass))
+        return true;
+
+    for (const QRegularExpression &pattern : m_patterns) {
+        if (pattern.match(windowClass).hasMatch())
+            return true;
+    }
+
+    return false;
+}
+
+}
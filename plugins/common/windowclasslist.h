@@ -0,0 +1,56 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef WINDOWCLASSLIST_H
+#define WINDOWCLASSLIST_H
+
+#include <QRegularExpression>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class KConfigGroup;
+
+namespace Cutefish
+{
+
+// A list of window classes ("resourceName resourceClass") loaded from a
+// config entry. Plain entries are matched exactly through a hash set,
+// entries written as /pattern/ are compiled once into regexes.
+class WindowClassList
+{
+public:
+    WindowClassList() = default;
+    explicit WindowClassList(const QStringList &entries);
+
+    void load(const KConfigGroup &group, const char *key, const QStringList &defaults);
+    void setEntries(const QStringList &entries);
+
+    bool contains(const QString &windowClass) const;
+    bool isEmpty() const { return m_exact.isEmpty() && m_patterns.isEmpty(); }
+
+private:
+    QSet<QString> m_exact;
+    QVector<QRegularExpression> m_patterns;
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "assetcache.h"
+
+// Qt
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+
+namespace Cutefish
+{
+
+namespace AssetCache
+{
+
+static const char s_magic[4] = { 'C', 'F', 'A', 'C' };
+static const quint32 s_version = 1;
+static const int s_headerSize = 32;
+static const int s_maxEntries = 128;
+
+namespace
+{
+
+struct Header {
+    char magic[4];
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 format;
+    quint64 checksum;
+};
+
+static_assert(sizeof(Header) == s_headerSize, "the header is written as is");
+
+QString cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QStringLiteral("/cutefish-decoration");
+}
+
+// FNV-1a over 64 bit words, enough to catch truncated or scribbled
+// files.
+quint64 checksum(const uchar *data, qint64 size)
+{
+    quint64 hash = 0xcbf29ce484222325ull;
+    qint64 i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        quint64 word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ull;
+    }
+    for (; i < size; ++i)
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+
+    return hash;
+}
+
+// Drops the least recently written entries, keys of old themes and
+// scales pile up otherwise.
+void prune(const QString &dirPath)
+{
+    QDir dir(dirPath);
+    const QFileInfoList entries = dir.entryInfoList({ QStringLiteral("*.img") }, QDir::Files, QDir::Time);
+
+    for (int i = s_maxEntries; i < entries.size(); ++i)
+        QFile::remove(entries.at(i).filePath());
+}
+
+}
+
+Key &Key::add(const QByteArray &data)
+{
+    m_data += QByteArray::number(data.size()) + ':' + data;
+    return *this;
+}
+
+Key &Key::addInt(qint64 value)
+{
+    return add(QByteArray::number(value));
+}
+
+Key &Key::addReal(qreal value)
+{
+    return add(QByteArray::number(value, 'g', 17));
+}
+
+QByteArray Key::fileName() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(s_version));
+    hash.addData(m_data);
+    return hash.result().toHex() + ".img";
+}
+
+QImage load(const Key &key)
+{
+    const QString path = cacheDir() + '/' + QString::fromLatin1(key.fileName());
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QImage();
+
+    // The entries are a few KiB, one read into the image is cheaper than
+    // mapping them, and QPixmap::fromImage() copies them anyway.
+    Header header;
+    bool valid = file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header)
+        && std::memcmp(header.magic, s_magic, sizeof(s_magic)) == 0
+        && header.version == s_version
+        && header.width > 0 && header.height > 0
+        && header.bytesPerLine == header.width * 4
+        && header.format == QImage::Format_ARGB32_Premultiplied
+        && file.size() == s_headerSize + qint64(header.bytesPerLine) * header.height;
+
+    QImage image;
+    if (valid) {
+        image = QImage(header.width, header.height, QImage::Format_ARGB32_Premultiplied);
+        const qint64 pixelBytes = image.sizeInBytes();
+
+        valid = !image.isNull()
+            && image.bytesPerLine() == qsizetype(header.bytesPerLine)
+            && file.read(reinterpret_cast<char *>(image.bits()), pixelBytes) == pixelBytes
+            && checksum(image.constBits(), pixelBytes) == header.checksum;
+    }
+
+    if (!valid) {
+        file.close();
+        QFile::remove(path);
+        return QImage();
+    }
+
+    return image;
+}
+
+void store(const Key &key, const QImage &source)
+{
+    if (source.isNull())
+        return;
+
+    QImage image = source.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    // Wrapped buffers may have padded lines, entries never do.
+    if (image.bytesPerLine() != image.width() * 4)
+        image = image.copy();
+
+    const QString dirPath = cacheDir();
+
+    if (!QDir().mkpath(dirPath))
+        return;
+
+    const qint64 pixelBytes = image.sizeInBytes();
+
+    Header header;
+    std::memcpy(header.magic, s_magic, sizeof(s_magic));
+    header.version = s_version;
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = image.bytesPerLine();
+    header.format = image.format();
+    header.checksum = checksum(image.constBits(), pixelBytes);
+
+    // Written to a temporary file and renamed over the entry, readers
+    // see either the old or the new file.
+    QSaveFile file(dirPath + '/' + QString::fromLatin1(key.fileName()));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(image.constBits()), pixelBytes);
+
+    if (file.commit())
+        prune(dirPath);
+}
+
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QByteArray>
+#include <QImage>
+
+namespace Cutefish
+{
+
+// Rasterized decoration assets kept in ~/.cache/cutefish-decoration
+// across kwin restarts.
+//
+// Entries are keyed by a hash of everything the image depends on: the
+// SVG source, the theme, the scale and the shadow parameters, plus the
+// cache format version. An entry is read straight into the pixels of a
+// new QImage. Writers rename a complete temporary file into place, so
+// concurrent kwin instances never see half an entry, and entries that
+// fail the size or checksum test are removed and rendered again.
+namespace AssetCache
+{
+
+// Everything a cached image depends on goes into the key.
+class Key
+{
+public:
+    Key &add(const QByteArray &data);
+    Key &addInt(qint64 value);
+    Key &addReal(qreal value);
+
+    QByteArray fileName() const;
+
+private:
+    QByteArray m_data;
+};
+
+// A null image when the entry is missing or damaged.
+QImage load(const Key &key);
+void store(const Key &key, const QImage &image);
+
+}
+
+}
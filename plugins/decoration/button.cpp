@@ -19,6 +19,7 @@
 
 #include "button.h"
 #include "decoration.h"
+#include "trace.h"
 
 #include <KDecoration3/DecoratedWindow>
 #include <KDecoration3/Decoration>
@@ -59,6 +60,8 @@ KDecoration3::DecorationButton *Button::create(KDecoration3::DecorationButtonTyp
 
 void Button::paint(QPainter *painter, const QRectF &repaintRegion)
 {
+    CUTEFISH_TRACE_SCOPE("Button::paint");
+
     Q_UNUSED(repaintRegion)
 
     Cutefish::Decoration *decoration = qobject_cast<Cutefish::Decoration *>(this->decoration());
@@ -20,6 +20,8 @@
 // own
 #include "decoration.h"
 #include "button.h"
+#include "themeassets.h"
+#include "trace.h"
 
 // KDecoration
 #include <KDecoration3/DecoratedWindow>
@@ -29,15 +31,11 @@
 // Qt
 #include <QApplication>
 #include <QPainter>
-#include <QSettings>
 #include <QSharedPointer>
-#include <QImageReader>
 #include <QTimer>
 
 #include <KPluginFactory>
 
-#include <cmath>
-
 K_PLUGIN_FACTORY_WITH_JSON(
     CutefishDecorationFactory,
     "cutefishos.json",
@@ -45,46 +43,38 @@ K_PLUGIN_FACTORY_WITH_JSON(
 
 namespace Cutefish
 {
-static int g_sDecoCount = 0;
-static int g_shadowSize = 0;
-static int g_shadowStrength = 0;
-static QColor g_shadowColor = Qt::black;
-static std::shared_ptr<KDecoration3::DecorationShadow> g_sShadow;
-
 Decoration::Decoration(QObject *parent, const QVariantList &args)
     : KDecoration3::Decoration(parent, args)
-    , m_settings(new QSettings(QSettings::UserScope, "cutefishos", "theme"))
-    , m_settingsFile(m_settings->fileName())
-    , m_fileWatcher(new QFileSystemWatcher)
+    , m_assets(ThemeAssets::instance())
     , m_x11Shadow(new X11Shadow)
 {
-    ++g_sDecoCount;
 }
 
 Decoration::~Decoration()
 {
-    if (--g_sDecoCount == 0) {
-        g_sShadow.reset();
-    }
+    if (m_scale > 0)
+        m_assets->release(m_scale);
 }
 
 void Decoration::paint(QPainter *painter, const QRectF &repaintArea)
 {
+    CUTEFISH_TRACE_SCOPE("Decoration::paint");
+
     auto *decoratedClient = window();
-    auto s = settings();
 
-    painter->fillRect(rect(), Qt::transparent);
+    // An opaque decoration paints every pixel below.
+    if (!isOpaque())
+        painter->fillRect(rect(), Qt::transparent);
 
     if (!decoratedClient->isShaded()) {
         // paintFrameBackground(painter, repaintArea);
 
-        painter->fillRect(rect(), Qt::transparent);
         painter->save();
         painter->setRenderHint(QPainter::Antialiasing);
         painter->setPen(Qt::NoPen);
         painter->setBrush(titleBarBackgroundColor());
 
-        if (s->isAlphaChannelSupported() && radiusAvailable()) {
+        if (!isOpaque()) {
             painter->drawRoundedRect(rect(), m_frameRadius, m_frameRadius);
         } else {
             painter->drawRect(rect());
@@ -105,12 +95,17 @@ bool Decoration::init()
     auto c = window();
     auto s = settings();
 
-    m_devicePixelRatio = m_settings->value("PixelRatio", 1.0).toReal();
-    m_frameRadius = 11 * m_devicePixelRatio;
+    m_devicePixelRatio = m_assets->devicePixelRatio();
+    m_frameRadius = m_assets->frameRadius();
+
+    m_scale = c->nextScale();
+    m_assets->acquire(m_scale);
 
     reconfigure();
     updateTitleBar();
+    updateOpaque();
 
+    connect(s.get(), &KDecoration3::DecorationSettings::alphaChannelSupportedChanged, this, &Decoration::updateOpaque);
     connect(s.get(), &KDecoration3::DecorationSettings::borderSizeChanged, this, &Decoration::recalculateBorders);
 
     // a change in font might cause the borders to change
@@ -143,29 +138,20 @@ bool Decoration::init()
 
     connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::updateTitleBar);
     connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::updateButtonsGeometry);
+    connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::updateOpaque);
+    connect(c, &KDecoration3::DecoratedWindow::shadedChanged, this, &Decoration::updateOpaque);
 
     connect(c, &KDecoration3::DecoratedWindow::widthChanged, this, &Decoration::updateButtonsGeometry);
     connect(c, &KDecoration3::DecoratedWindow::adjacentScreenEdgesChanged, this, &Decoration::updateButtonsGeometry);
     connect(c, &KDecoration3::DecoratedWindow::shadedChanged, this, &Decoration::updateButtonsGeometry);
 
-    // cutefishos settings
-    m_fileWatcher->addPath(m_settingsFile);
-    connect(m_fileWatcher, &QFileSystemWatcher::fileChanged, this, [=] {
-        m_settings->sync();
-        m_devicePixelRatio = m_settings->value("PixelRatio", 1.0).toReal();
+    // the buttons are rasterized for the output the window is on
+    connect(c, &KDecoration3::DecoratedWindow::nextScaleChanged, this, &Decoration::updateScale);
 
-        updateBtnPixmap();
-        update(titleBar());
-        updateTitleBar();
-        updateButtonsGeometry();
-        reconfigure();
+    // cutefishos settings, the assets are re-rendered off the main thread
+    connect(m_assets.get(), &ThemeAssets::changed, this, &Decoration::updateTheme);
+    connect(m_assets.get(), &ThemeAssets::buttonsChanged, this, &Decoration::updateButtons);
 
-        bool fileDeleted = !m_fileWatcher->files().contains(m_settingsFile);
-        if (fileDeleted)
-            m_fileWatcher->addPath(m_settingsFile);
-    });
-
-    updateBtnPixmap();
     createButtons();
 
     // // For some reason, the shadow should be installed the last. Otherwise,
@@ -254,104 +240,71 @@ void Decoration::updateButtonsGeometry()
 
 void Decoration::updateShadow()
 {
-    // assign global shadow if exists and parameters match
-    if (!g_sShadow) {
-        // assign parameters
-        g_shadowSize = 90;
-        g_shadowStrength = 35;
-        g_shadowColor = Qt::black;
-        const int shadowOverlap = m_frameRadius;
-        // const int shadowOffset = qMax(6 * g_shadowSize / 16, shadowOverlap * 2);
-        const int shadowOffset = shadowOverlap / 2;
-
-        // create image
-        QImage image(2 * g_shadowSize, 2 * g_shadowSize, QImage::Format_ARGB32_Premultiplied);
-        image.fill(Qt::transparent);
-
-        // create gradient
-        // gaussian delta function
-        auto alpha = [](qreal x) { return std::exp( -x*x/0.15 ); };
-
-        // color calculation delta function
-        auto gradientStopColor = [](QColor color, int alpha) {
-            color.setAlpha(alpha);
-            return color;
-        };
-
-        QRadialGradient radialGradient(g_shadowSize, g_shadowSize, g_shadowSize);
-        for (int i = 0; i < 10; ++i) {
-            const qreal x(qreal( i ) / 9);
-            radialGradient.setColorAt(x, gradientStopColor(g_shadowColor, alpha(x) * g_shadowStrength));
-        }
+    CUTEFISH_TRACE_SCOPE("Decoration::updateShadow");
 
-        radialGradient.setColorAt(1, gradientStopColor(g_shadowColor, 0 ));
-
-        QPainter painter;
-        // fill
-        painter.begin(&image);
-        //TODO review these
-        //QPainter painter(&image);
-        painter.setRenderHint( QPainter::Antialiasing, true );
-        painter.fillRect( image.rect(), radialGradient);
-
-        // contrast pixel
-        QRectF innerRect = QRectF(
-            g_shadowSize - shadowOverlap, g_shadowSize - shadowOffset - shadowOverlap,
-            2 * shadowOverlap, shadowOffset + 2 * shadowOverlap );
-            // g_shadowSize - shadowOffset - shadowOverlap, g_shadowSize - shadowOffset - shadowOverlap,
-            // shadowOffset + 2*shadowOverlap, shadowOffset + 2*shadowOverlap );
-
-        painter.setPen( gradientStopColor(g_shadowColor, g_shadowStrength * 0.5));
-        painter.setBrush(Qt::NoBrush);
-        painter.drawRoundedRect(innerRect, -0.5 + m_frameRadius, -0.5 + m_frameRadius);
-
-        // mask out inner rect
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(Qt::black);
-        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
-        painter.drawRoundedRect(innerRect, 0.5 + m_frameRadius, 0.5 + m_frameRadius);
-        painter.end();
-
-        auto shadow = std::make_shared<KDecoration3::DecorationShadow>();
-        shadow->setPadding( QMargins(
-        // g_shadowSize - shadowOffset - shadowOverlap,
-        g_shadowSize - shadowOverlap,
-        g_shadowSize - shadowOffset - shadowOverlap,
-        g_shadowSize - shadowOverlap,
-        g_shadowSize - shadowOverlap));
-
-        shadow->setInnerShadowRect(QRect(g_shadowSize, g_shadowSize, 1, 1));
-
-        // assign image
-        shadow->setShadow(image);
-        
-        g_sShadow = shadow;
-    }
+    setShadow(m_assets->shadow());
+}
+
+void Decoration::updateTheme()
+{
+    m_devicePixelRatio = m_assets->devicePixelRatio();
+    m_frameRadius = m_assets->frameRadius();
+
+    updateTitleBar();
+    updateButtonsGeometry();
+    reconfigure();
+}
+
+void Decoration::updateScale()
+{
+    const qreal scale = window()->nextScale();
+    if (qFuzzyCompare(scale, m_scale))
+        return;
 
-    setShadow(g_sShadow);
+    // Acquire first, so moving the last window between two outputs of
+    // the same scale does not drop and re-render it.
+    m_assets->acquire(scale);
+    m_assets->release(m_scale);
+    m_scale = scale;
+
+    update();
 }
 
-void Decoration::updateBtnPixmap()
+void Decoration::updateButtons(qreal scale)
 {
-    int size = 24;
-    QString dirName = darkMode() ? "dark" : "light";
+    // Until now the buttons of another scale were painted.
+    if (ThemeAssets::scaleKey(scale) == ThemeAssets::scaleKey(m_scale))
+        update();
+}
 
-    m_closeBtnPixmap = fromSvgToPixmap(QString(":/images/%1/close_normal.svg").arg(dirName), QSize(size, size));
-    m_maximizeBtnPixmap = fromSvgToPixmap(QString(":/images/%1/maximize_normal.svg").arg(dirName), QSize(size, size));
-    m_minimizeBtnPixmap = fromSvgToPixmap(QString(":/images/%1/minimize_normal.svg").arg(dirName), QSize(size, size));
-    m_restoreBtnPixmap = fromSvgToPixmap(QString(":/images/%1/restore_normal.svg").arg(dirName), QSize(size, size));
+void Decoration::updateOpaque()
+{
+    // Without rounded corners the titlebar is a solid rectangle, kwin
+    // then skips blending it and culls what is behind it. Shaded windows
+    // don't paint their background.
+    const bool rectangular = !settings()->isAlphaChannelSupported() || !radiusAvailable();
+    setOpaque(rectangular && !window()->isShaded());
+    update();
 }
 
-QPixmap Decoration::fromSvgToPixmap(const QString &file, const QSize &size)
+QPixmap Decoration::closeBtnPixmap() const
 {
-    QImageReader reader(file);
+    return m_assets->pixmap(ThemeAssets::CloseButton, m_scale);
+}
 
-    if (reader.canRead()) {
-        reader.setScaledSize(size * m_devicePixelRatio);
-        return QPixmap::fromImage(reader.read());
-    }
+QPixmap Decoration::maximizeBtnPixmap() const
+{
+    return m_assets->pixmap(ThemeAssets::MaximizeButton, m_scale);
+}
 
-    return QPixmap();
+QPixmap Decoration::minimizeBtnPixmap() const
+{
+    return m_assets->pixmap(ThemeAssets::MinimizeButton, m_scale);
+}
+
+QPixmap Decoration::restoreBtnPixmap() const
+{
+    return m_assets->pixmap(ThemeAssets::RestoreButton, m_scale);
 }
 
 int Decoration::titleBarHeight() const
@@ -365,8 +318,7 @@ int Decoration::titleBarHeight() const
 
 bool Decoration::darkMode() const
 {
-    QSettings settings(QSettings::UserScope, "cutefishos", "theme");
-    return settings.value("DarkMode", false).toBool();
+    return m_assets->darkMode();
 }
 
 bool Decoration::radiusAvailable()
@@ -416,6 +368,8 @@ QColor Decoration::titleBarForegroundColor()
 
 void Decoration::paintCaption(QPainter *painter, const QRectF &repaintRegion)
 {
+    CUTEFISH_TRACE_SCOPE("Decoration::paintCaption");
+
     Q_UNUSED(repaintRegion)
 
     const auto *decoratedClient = const_cast<Decoration*>(this)->window();
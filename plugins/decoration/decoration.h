@@ -24,16 +24,17 @@
 #include <KDecoration3/DecorationButtonGroup>
 
 // Qt
-#include <QFileSystemWatcher>
-#include <QSettings>
 #include <QVariant>
 #include <QIcon>
 
+#include <memory>
+
 #include "x11shadow.h"
 
 namespace Cutefish
 {
 
+class ThemeAssets;
 class CloseButton;
 class MaximizeButton;
 class MinimizeButton;
@@ -48,10 +49,10 @@ public:
 
     void paint(QPainter *painter, const QRectF &repaintArea) override;
 
-    QPixmap closeBtnPixmap() { return m_closeBtnPixmap; }
-    QPixmap maximizeBtnPixmap() { return m_maximizeBtnPixmap; }
-    QPixmap minimizeBtnPixmap() { return m_minimizeBtnPixmap; }
-    QPixmap restoreBtnPixmap() { return m_restoreBtnPixmap; }
+    QPixmap closeBtnPixmap() const;
+    QPixmap maximizeBtnPixmap() const;
+    QPixmap minimizeBtnPixmap() const;
+    QPixmap restoreBtnPixmap() const;
 
     bool darkMode() const;
     qreal devicePixelRatio() const { return m_devicePixelRatio; }
@@ -68,9 +69,10 @@ private:
     void updateButtonsGeometryDelayed();
     void updateButtonsGeometry();
     void updateShadow();
-
-    void updateBtnPixmap();
-    QPixmap fromSvgToPixmap(const QString &file, const QSize &size);
+    void updateTheme();
+    void updateScale();
+    void updateButtons(qreal scale);
+    void updateOpaque();
 
     int titleBarHeight() const;
 
@@ -95,6 +97,7 @@ private:
     int m_titleBarHeight = 30;
     int m_frameRadius = 11;
     qreal m_devicePixelRatio = 1.0;
+    qreal m_scale = 0.0;
     QColor m_titleBarBgColor = QColor(255, 255, 255, 255);
     QColor m_titleBarFgColor = QColor(56, 56, 56, 255);
     QColor m_unfocusedFgColor = QColor(127, 127, 127, 255);
@@ -103,14 +106,7 @@ private:
     QColor m_titleBarFgDarkColor = QColor(202, 203, 206);
     QColor m_unfocusedFgDarkColor = QColor(112, 112, 112);
 
-    QSettings *m_settings;
-    QString m_settingsFile;
-    QFileSystemWatcher *m_fileWatcher;
-
-    QPixmap m_closeBtnPixmap;
-    QPixmap m_maximizeBtnPixmap;
-    QPixmap m_minimizeBtnPixmap;
-    QPixmap m_restoreBtnPixmap;
+    std::shared_ptr<ThemeAssets> m_assets;
 
     X11Shadow *m_x11Shadow;
 };
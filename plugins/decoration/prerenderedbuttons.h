@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Qt
+#include <QImage>
+#include <QString>
+
+namespace Cutefish
+{
+
+// Button SVGs rasterized at the common scales by rasterizebuttons while
+// building the plugin, see CMakeLists.txt. The pixels are premultiplied
+// ARGB32 in the plugin's read-only data and are wrapped without copying.
+namespace PrerenderedButtons
+{
+
+struct Entry {
+    const char *name;
+    bool darkMode;
+    int size;
+    const uchar *bits;
+};
+
+// Defined in the generated prerenderedbuttons.cpp.
+extern const Entry entries[];
+extern const int entryCount;
+
+// A null image when the button was not rendered at this size, the
+// caller falls back to the SVG.
+inline QImage find(const QString &name, bool darkMode, const QSize &size)
+{
+#ifdef CUTEFISH_PRERENDERED_BUTTONS
+    if (size.width() != size.height())
+        return QImage();
+
+    for (int i = 0; i < entryCount; ++i) {
+        const Entry &entry = entries[i];
+        if (entry.size == size.width() && entry.darkMode == darkMode && name == QLatin1String(entry.name))
+            return QImage(entry.bits, entry.size, entry.size, entry.size * 4, QImage::Format_ARGB32_Premultiplied);
+    }
+#else
+    Q_UNUSED(name)
+    Q_UNUSED(darkMode)
+    Q_UNUSED(size)
+#endif
+
+    return QImage();
+}
+
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Build time helper: rasterizes every button SVG at the given scales
+// into the C++ source of the tables in prerenderedbuttons.h.
+//
+//   rasterizebuttons <images dir> <output.cpp> <scale>...
+
+// Qt
+#include <QGuiApplication>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QTextStream>
+
+static const int s_buttonSize = 24;
+
+int main(int argc, char *argv[])
+{
+    // No display while building.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.size() < 4) {
+        QTextStream(stderr) << "usage: rasterizebuttons <images dir> <output.cpp> <scale>...\n";
+        return 2;
+    }
+
+    const QString imagesDir = args.at(1);
+    const QStringList names = { "close", "maximize", "minimize", "restore" };
+
+    QString source;
+    QTextStream out(&source);
+    QString table;
+    QTextStream entries(&table);
+    int count = 0;
+
+    out << "// Generated by rasterizebuttons, do not edit.\n\n"
+        << "#include \"prerenderedbuttons.h\"\n\n"
+        << "namespace Cutefish\n{\n\nnamespace PrerenderedButtons\n{\n\n";
+
+    for (const bool darkMode : { false, true }) {
+        for (const QString &name : names) {
+            const QString path = QString("%1/%2/%3_normal.svg").arg(imagesDir, darkMode ? QStringLiteral("dark") : QStringLiteral("light"), name);
+
+            for (int i = 3; i < args.size(); ++i) {
+                // The same rounding as ThemeAssets::renderButton(), so
+                // the runtime lookup hits.
+                const QSize size = QSize(s_buttonSize, s_buttonSize) * args.at(i).toDouble();
+
+                QImageReader reader(path);
+                reader.setScaledSize(size);
+                const QImage image = reader.read().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+                if (image.isNull() || image.size() != size) {
+                    QTextStream(stderr) << "rasterizebuttons: cannot render " << path << ": " << reader.errorString() << '\n';
+                    return 1;
+                }
+
+                // Words rather than bytes, the pixel layout in memory is
+                // the one of the target.
+                out << "static const quint32 pixels" << count << "[] = {";
+                for (int y = 0; y < image.height(); ++y) {
+                    const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+                    for (int x = 0; x < image.width(); ++x) {
+                        if ((y * image.width() + x) % 8 == 0)
+                            out << "\n   ";
+                        out << " 0x" << QString::number(line[x], 16).rightJustified(8, '0') << ',';
+                    }
+                }
+                out << "\n};\n\n";
+
+                entries << "    { \"" << name << "\", " << (darkMode ? "true" : "false") << ", " << size.width()
+                        << ", reinterpret_cast<const uchar *>(pixels" << count << ") },\n";
+                ++count;
+            }
+        }
+    }
+
+    entries.flush();
+    out << "const Entry entries[] = {\n" << table << "};\n\n"
+        << "const int entryCount = " << count << ";\n\n"
+        << "}\n\n}\n";
+    out.flush();
+
+    QSaveFile file(args.at(2));
+    if (!file.open(QIODevice::WriteOnly) || file.write(source.toUtf8()) < 0 || !file.commit()) {
+        QTextStream(stderr) << "rasterizebuttons: cannot write " << args.at(2) << '\n';
+        return 1;
+    }
+
+    return 0;
+}
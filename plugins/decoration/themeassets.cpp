@@ -0,0 +1,458 @@
+/*
+ * Copyright (C) 2026 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "themeassets.h"
+#include "assetcache.h"
+#include "prerenderedbuttons.h"
+
+// Qt
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QPainter>
+#include <QRadialGradient>
+#include <QtConcurrent>
+
+#include <climits>
+#include <cmath>
+
+namespace Cutefish
+{
+
+static const int s_buttonSize = 24;
+static const int s_shadowSize = 90;
+static const int s_shadowStrength = 35;
+static const QColor s_shadowColor = Qt::black;
+
+std::shared_ptr<ThemeAssets> ThemeAssets::instance()
+{
+    // Lives as long as at least one decoration does.
+    static std::weak_ptr<ThemeAssets> s_instance;
+
+    std::shared_ptr<ThemeAssets> assets = s_instance.lock();
+    if (!assets) {
+        assets.reset(new ThemeAssets);
+        s_instance = assets;
+    }
+
+    return assets;
+}
+
+ThemeAssets::ThemeAssets()
+    : m_traceDumper("decoration")
+    , m_statsExporter("decoration")
+    , m_buttonStats(QStringLiteral("decoration/buttons"))
+    , m_shadowStats(QStringLiteral("decoration/shadow"))
+    , m_settingsStats(QStringLiteral("decoration/theme settings"))
+    , m_settings(QSettings::UserScope, "cutefishos", "theme")
+{
+    m_darkMode = m_settings.value("DarkMode", false).toBool();
+    m_devicePixelRatio = m_settings.value("PixelRatio", 1.0).toReal();
+
+    // The first decoration needs its shadow right away.
+    const QList<Job> shadowJob = { { Shadow, m_darkMode, m_devicePixelRatio, 1.0 } };
+    apply(shadowJob, { render(shadowJob.first()) });
+
+    connect(&m_futureWatcher, &QFutureWatcherBase::finished, this, [this] {
+        const QList<Job> jobs = m_runningJobs;
+        m_runningJobs.clear();
+        apply(jobs, m_futureWatcher.future().results());
+
+        // A theme reload brings a new shadow and every decoration has to
+        // relayout. New buttons only need the windows on their scale to
+        // repaint.
+        QList<int> scales;
+        bool reloaded = false;
+        for (const Job &job : jobs) {
+            if (job.asset == Shadow)
+                reloaded = true;
+            else if (!scales.contains(scaleKey(job.scale)))
+                scales.append(scaleKey(job.scale));
+        }
+
+        if (reloaded) {
+            emit changed();
+        } else {
+            for (int key : std::as_const(scales))
+                emit buttonsChanged(key / 120.0);
+        }
+
+        if (m_reloadPending) {
+            m_reloadPending = false;
+            reload();
+        } else {
+            startJobs();
+        }
+    });
+
+    m_fileWatcher.addPath(m_settings.fileName());
+    updateStats();
+
+    connect(&m_fileWatcher, &QFileSystemWatcher::fileChanged, this, [this] {
+        if (!m_fileWatcher.files().contains(m_settings.fileName()))
+            m_fileWatcher.addPath(m_settings.fileName());
+
+        reload();
+    });
+}
+
+ThemeAssets::~ThemeAssets()
+{
+    m_futureWatcher.waitForFinished();
+}
+
+int ThemeAssets::frameRadius() const
+{
+    return 11 * m_devicePixelRatio;
+}
+
+void ThemeAssets::acquire(qreal scale)
+{
+    ScaledAssets &assets = m_scaled[scaleKey(scale)];
+
+    if (assets.users++ > 0) {
+        m_buttonStats.hit();
+        return;
+    }
+
+    // A window is shown on this output for the first time. Buttons that
+    // were rendered while building the plugin or are in the disk cache
+    // are there right away. Don't hold up the compositor for those that
+    // have to be rasterized, it paints the ones of another scale until
+    // buttonsChanged() is emitted.
+    m_buttonStats.miss();
+
+    QList<Job> loaded;
+    QList<QImage> images;
+    for (const Job &job : buttonJobs(scale)) {
+        const QImage image = loadButton(buttonName(job.asset), job.darkMode, job.devicePixelRatio * job.scale);
+        if (image.isNull()) {
+            m_queuedJobs.append(job);
+        } else {
+            loaded.append(job);
+            images.append(image);
+        }
+    }
+
+    if (!loaded.isEmpty())
+        apply(loaded, images);
+
+    startJobs();
+}
+
+void ThemeAssets::release(qreal scale)
+{
+    auto it = m_scaled.find(scaleKey(scale));
+    if (it == m_scaled.end())
+        return;
+
+    if (--it->users == 0) {
+        m_scaled.erase(it);
+        m_buttonStats.evicted();
+        updateStats();
+    }
+}
+
+QPixmap ThemeAssets::pixmap(Asset asset, qreal scale) const
+{
+    if (asset >= Shadow)
+        return QPixmap();
+
+    const int key = scaleKey(scale);
+    auto it = m_scaled.constFind(key);
+    if (it != m_scaled.cend() && !it->pixmaps[asset].isNull())
+        return it->pixmaps[asset];
+
+    // Still rendering, take the closest scale that is ready.
+    QPixmap nearest;
+    int distance = INT_MAX;
+    for (it = m_scaled.cbegin(); it != m_scaled.cend(); ++it) {
+        if (!it->pixmaps[asset].isNull() && qAbs(it.key() - key) < distance) {
+            nearest = it->pixmaps[asset];
+            distance = qAbs(it.key() - key);
+        }
+    }
+
+    return nearest;
+}
+
+QList<ThemeAssets::Job> ThemeAssets::buttonJobs(qreal scale) const
+{
+    QList<Job> jobs;
+
+    for (int i = CloseButton; i < Shadow; ++i)
+        jobs.append({ static_cast<Asset>(i), m_darkMode, m_devicePixelRatio, scale });
+
+    return jobs;
+}
+
+void ThemeAssets::startJobs()
+{
+    // One batch at a time, the next starts when this one is applied.
+    if (m_futureWatcher.isRunning() || m_queuedJobs.isEmpty())
+        return;
+
+    m_runningJobs = m_queuedJobs;
+    m_queuedJobs.clear();
+    m_futureWatcher.setFuture(QtConcurrent::mapped(m_runningJobs, &ThemeAssets::render));
+}
+
+void ThemeAssets::reload()
+{
+    // A rasterization is still running for an older state of the file,
+    // start over once it is done.
+    if (m_futureWatcher.isRunning()) {
+        m_reloadPending = true;
+        return;
+    }
+
+    m_settings.sync();
+    m_darkMode = m_settings.value("DarkMode", false).toBool();
+    m_devicePixelRatio = m_settings.value("PixelRatio", 1.0).toReal();
+
+    // Only the scales that are on screen right now, others are rendered
+    // when a window shows up there. This covers the queued ones too,
+    // which still had the old theme.
+    m_queuedJobs = { { Shadow, m_darkMode, m_devicePixelRatio, 1.0 } };
+    for (auto it = m_scaled.cbegin(); it != m_scaled.cend(); ++it)
+        m_queuedJobs += buttonJobs(it.key() / 120.0);
+
+    startJobs();
+}
+
+void ThemeAssets::apply(const QList<Job> &jobs, const QList<QImage> &images)
+{
+    if (images.size() != jobs.size())
+        return;
+
+    // QPixmap and the shadow object belong to the main thread, the workers
+    // only produce QImages.
+    for (int i = 0; i < jobs.size(); ++i) {
+        const Job &job = jobs.at(i);
+
+        if (job.asset == Shadow) {
+            auto shadow = std::make_shared<KDecoration3::DecorationShadow>();
+            shadow->setPadding(shadowPadding(frameRadius()));
+            shadow->setInnerShadowRect(QRect(s_shadowSize, s_shadowSize, 1, 1));
+            shadow->setShadow(images.at(i));
+            m_shadow = shadow;
+            continue;
+        }
+
+        // The scale may have been released while this was rendering.
+        auto it = m_scaled.find(scaleKey(job.scale));
+        if (it == m_scaled.end())
+            continue;
+
+        QPixmap pixmap = QPixmap::fromImage(images.at(i));
+        pixmap.setDevicePixelRatio(job.scale);
+        it->pixmaps[job.asset] = pixmap;
+    }
+
+    updateStats();
+}
+
+void ThemeAssets::updateStats()
+{
+    auto bytes = [](const QPixmap &pixmap) {
+        return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    };
+
+    qint64 buttons = 0;
+    qint64 buttonBytes = 0;
+    for (const ScaledAssets &assets : std::as_const(m_scaled)) {
+        for (const QPixmap &pixmap : assets.pixmaps) {
+            buttons += !pixmap.isNull();
+            buttonBytes += bytes(pixmap);
+        }
+    }
+    m_buttonStats.setUsage(buttons, buttonBytes);
+
+    const QImage shadow = m_shadow ? m_shadow->shadow() : QImage();
+    m_shadowStats.setUsage(m_shadow ? 1 : 0, shadow.sizeInBytes());
+
+    // The parsed settings are about the size of the file.
+    m_settingsStats.setUsage(1 + m_fileWatcher.files().size(), QFileInfo(m_settings.fileName()).size());
+}
+
+QImage ThemeAssets::render(const Job &job)
+{
+    CUTEFISH_TRACE_SCOPE("ThemeAssets::render");
+
+    switch (job.asset) {
+    case CloseButton:
+    case MaximizeButton:
+    case MinimizeButton:
+    case RestoreButton:
+        return renderButton(buttonName(job.asset), job.darkMode, job.devicePixelRatio * job.scale);
+    case Shadow:
+        return renderShadow(11 * job.devicePixelRatio);
+    default:
+        return QImage();
+    }
+}
+
+QString ThemeAssets::buttonName(Asset asset)
+{
+    switch (asset) {
+    case CloseButton:
+        return QStringLiteral("close");
+    case MaximizeButton:
+        return QStringLiteral("maximize");
+    case MinimizeButton:
+        return QStringLiteral("minimize");
+    case RestoreButton:
+        return QStringLiteral("restore");
+    default:
+        return QString();
+    }
+}
+
+static QString buttonPath(const QString &name, bool darkMode)
+{
+    return QString(":/images/%1/%2_normal.svg").arg(darkMode ? "dark" : "light", name);
+}
+
+static QSize buttonSize(qreal devicePixelRatio)
+{
+    return QSize(s_buttonSize, s_buttonSize) * devicePixelRatio;
+}
+
+// Keyed by the SVG itself, an updated icon theme never hits an old
+// entry.
+static AssetCache::Key buttonKey(const QString &path, const QSize &size)
+{
+    AssetCache::Key key;
+    key.add("button");
+
+    QFile source(path);
+    if (source.open(QIODevice::ReadOnly))
+        key.add(source.readAll());
+
+    key.addInt(size.width()).addInt(size.height());
+    return key;
+}
+
+QImage ThemeAssets::loadButton(const QString &name, bool darkMode, qreal devicePixelRatio)
+{
+    const QSize size = buttonSize(devicePixelRatio);
+
+    // Common scales were rendered while building the plugin.
+    const QImage image = PrerenderedButtons::find(name, darkMode, size);
+    if (!image.isNull())
+        return image;
+
+    return AssetCache::load(buttonKey(buttonPath(name, darkMode), size));
+}
+
+QImage ThemeAssets::renderButton(const QString &name, bool darkMode, qreal devicePixelRatio)
+{
+    QImage image = loadButton(name, darkMode, devicePixelRatio);
+    if (!image.isNull())
+        return image;
+
+    const QString path = buttonPath(name, darkMode);
+    const QSize size = buttonSize(devicePixelRatio);
+
+    QImageReader reader(path);
+    if (reader.canRead()) {
+        reader.setScaledSize(size);
+        image = reader.read();
+        AssetCache::store(buttonKey(path, size), image);
+    }
+
+    return image;
+}
+
+QMargins ThemeAssets::shadowPadding(int frameRadius)
+{
+    const int shadowOverlap = frameRadius;
+    const int shadowOffset = shadowOverlap / 2;
+
+    return QMargins(s_shadowSize - shadowOverlap,
+                    s_shadowSize - shadowOffset - shadowOverlap,
+                    s_shadowSize - shadowOverlap,
+                    s_shadowSize - shadowOverlap);
+}
+
+QImage ThemeAssets::renderShadow(int frameRadius)
+{
+    AssetCache::Key key;
+    key.add("shadow").addInt(frameRadius).addInt(s_shadowSize).addInt(s_shadowStrength).addInt(s_shadowColor.rgba());
+
+    QImage image = AssetCache::load(key);
+    if (image.isNull()) {
+        image = paintShadow(frameRadius);
+        AssetCache::store(key, image);
+    }
+
+    return image;
+}
+
+QImage ThemeAssets::paintShadow(int frameRadius)
+{
+    const int shadowOverlap = frameRadius;
+    const int shadowOffset = shadowOverlap / 2;
+
+    // create image
+    QImage image(2 * s_shadowSize, 2 * s_shadowSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    // create gradient
+    // gaussian delta function
+    auto alpha = [](qreal x) { return std::exp( -x*x/0.15 ); };
+
+    // color calculation delta function
+    auto gradientStopColor = [](QColor color, int alpha) {
+        color.setAlpha(alpha);
+        return color;
+    };
+
+    QRadialGradient radialGradient(s_shadowSize, s_shadowSize, s_shadowSize);
+    for (int i = 0; i < 10; ++i) {
+        const qreal x(qreal( i ) / 9);
+        radialGradient.setColorAt(x, gradientStopColor(s_shadowColor, alpha(x) * s_shadowStrength));
+    }
+
+    radialGradient.setColorAt(1, gradientStopColor(s_shadowColor, 0 ));
+
+    QPainter painter;
+    // fill
+    painter.begin(&image);
+    painter.setRenderHint( QPainter::Antialiasing, true );
+    painter.fillRect( image.rect(), radialGradient);
+
+    // contrast pixel
+    QRectF innerRect = QRectF(
+        s_shadowSize - shadowOverlap, s_shadowSize - shadowOffset - shadowOverlap,
+        2 * shadowOverlap, shadowOffset + 2 * shadowOverlap );
+
+    painter.setPen( gradientStopColor(s_shadowColor, s_shadowStrength * 0.5));
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRoundedRect(innerRect, -0.5 + frameRadius, -0.5 + frameRadius);
+
+    // mask out inner rect
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
+    painter.drawRoundedRect(innerRect, 0.5 + frameRadius, 0.5 + frameRadius);
+    painter.end();
+
+    return image;
+}
+
+}
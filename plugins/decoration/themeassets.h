@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 CutefishOS Team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// KDecoration
+#include <KDecoration3/DecorationShadow>
+
+// Qt
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QSettings>
+
+#include <memory>
+
+#include "cachestats.h"
+#include "trace.h"
+
+namespace Cutefish
+{
+
+// Theme dependent assets shared by all decorations.
+//
+// There is one settings watcher for all windows. When the theme changes,
+// the new assets are rasterized on the global thread pool and swapped in
+// at once on the main thread, then changed() is emitted so every
+// decoration relayouts and repaints a single time.
+//
+// The buttons are rasterized once per output scale in use, so a window
+// on a scaled output gets pixmaps at its exact size instead of ones
+// resampled by the compositor. Sizes built with the plugin or found in
+// the disk cache are loaded right away, others are rasterized on the
+// thread pool as well. Until those are done pixmap() returns the buttons
+// of the nearest scale, and buttonsChanged() tells the decorations on
+// that scale to repaint.
+class ThemeAssets : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Asset {
+        CloseButton,
+        MaximizeButton,
+        MinimizeButton,
+        RestoreButton,
+        Shadow,
+        AssetCount
+    };
+
+    static std::shared_ptr<ThemeAssets> instance();
+
+    ~ThemeAssets() override;
+
+    bool darkMode() const { return m_darkMode; }
+    qreal devicePixelRatio() const { return m_devicePixelRatio; }
+    int frameRadius() const;
+
+    // A decoration acquires the scale of the output its window is on.
+    // The buttons of a scale are queued for rendering on its first
+    // acquire(), buttonsChanged() is emitted once they are in, and they
+    // are dropped after its last release().
+    void acquire(qreal scale);
+    void release(qreal scale);
+
+    QPixmap pixmap(Asset asset, qreal scale) const;
+    std::shared_ptr<KDecoration3::DecorationShadow> shadow() const { return m_shadow; }
+
+    // Fractional output scales are multiples of 1/120.
+    static int scaleKey(qreal scale) { return qRound(scale * 120); }
+
+signals:
+    void changed();
+    void buttonsChanged(qreal scale);
+
+private:
+    struct Job {
+        Asset asset;
+        bool darkMode;
+        qreal devicePixelRatio;
+        qreal scale;
+    };
+
+    struct ScaledAssets {
+        QPixmap pixmaps[Shadow];
+        int users = 0;
+    };
+
+    ThemeAssets();
+
+    QList<Job> buttonJobs(qreal scale) const;
+    void startJobs();
+    void reload();
+    void apply(const QList<Job> &jobs, const QList<QImage> &images);
+    void updateStats();
+
+    static QImage render(const Job &job);
+    static QString buttonName(Asset asset);
+    // Only the buttons built with the plugin or in the disk cache, a null
+    // image for those that have to be rasterized.
+    static QImage loadButton(const QString &name, bool darkMode, qreal devicePixelRatio);
+    static QImage renderButton(const QString &name, bool darkMode, qreal devicePixelRatio);
+    static QImage renderShadow(int frameRadius);
+    static QImage paintShadow(int frameRadius);
+    static QMargins shadowPadding(int frameRadius);
+
+    Trace::Dumper m_traceDumper;
+    CacheStats::Exporter m_statsExporter;
+    CacheStats m_buttonStats;
+    CacheStats m_shadowStats;
+    CacheStats m_settingsStats;
+
+    QSettings m_settings;
+    QFileSystemWatcher m_fileWatcher;
+    QFutureWatcher<QImage> m_futureWatcher;
+    QList<Job> m_runningJobs;
+    QList<Job> m_queuedJobs;
+    bool m_reloadPending = false;
+
+    bool m_darkMode = false;
+    qreal m_devicePixelRatio = 1.0;
+
+    QHash<int, ScaledAssets> m_scaled;
+    std::shared_ptr<KDecoration3::DecorationShadow> m_shadow;
+};
+
+}
@@ -0,0 +1,42 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "recorder.h"
+#include <KPluginFactory>
+
+class RecorderEffectPluginFactory : public KWin::EffectPluginFactory
+{
+    Q_OBJECT
+    Q_INTERFACES(KPluginFactory)
+    Q_PLUGIN_METADATA(IID KPluginFactory_iid FILE "recorder.json")
+
+public:
+    explicit RecorderEffectPluginFactory();
+    ~RecorderEffectPluginFactory();
+
+    KWin::Effect * createEffect() const override
+    {
+        return new RecorderEffect;
+    }
+};
+
+K_PLUGIN_FACTORY_DEFINITION(RecorderEffectPluginFactory, registerPlugin<RecorderEffect>();)
+K_EXPORT_PLUGIN_VERSION(KWIN_EFFECT_API_VERSION)
+
+#include "main.moc"
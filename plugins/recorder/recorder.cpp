@@ -0,0 +1,270 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "recorder.h"
+
+// KDE
+#include <KConfigGroup>
+
+// Qt
+#include <QCoreApplication>
+#include <QDebug>
+#include <QStandardPaths>
+
+using namespace Cutefish;
+
+RecorderEffect::RecorderEffect(QObject *, const QVariantList &)
+    : KWin::Effect()
+{
+    connect(KWin::effects, &KWin::EffectsHandler::windowAdded, this, &RecorderEffect::slotWindowAdded);
+    connect(KWin::effects, &KWin::EffectsHandler::windowClosed, this, &RecorderEffect::slotWindowClosed);
+    connect(KWin::effects, &KWin::EffectsHandler::windowDeleted, this, &RecorderEffect::slotWindowDeleted);
+    connect(KWin::effects, &KWin::EffectsHandler::windowMinimized, this, &RecorderEffect::slotWindowMinimized);
+    connect(KWin::effects, &KWin::EffectsHandler::windowUnminimized, this, &RecorderEffect::slotWindowUnminimized);
+    connect(KWin::effects, &KWin::EffectsHandler::windowMaximizedStateChanged, this, &RecorderEffect::slotWindowMaximizedStateChanged);
+    connect(KWin::effects, &KWin::EffectsHandler::windowFrameGeometryChanged, this, &RecorderEffect::slotWindowFrameGeometryChanged);
+
+    reconfigure(ReconfigureAll);
+}
+
+RecorderEffect::~RecorderEffect()
+{
+    if (m_writer.isOpen())
+        qDebug() << "Cutefish recorder: wrote" << m_writer.size() << "bytes to" << m_writer.path();
+}
+
+bool RecorderEffect::supported()
+{
+    return true;
+}
+
+bool RecorderEffect::enabledByDefault()
+{
+    return false;
+}
+
+void RecorderEffect::reconfigure(ReconfigureFlags flags)
+{
+    Q_UNUSED(flags)
+
+    KConfigGroup conf = KWin::effects->effectConfig(QStringLiteral("cutefishrecorder"));
+
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty())
+        dir = QStringLiteral("/tmp");
+
+    const QString defaultPath = QStringLiteral("%1/cutefish-events-%2.bin").arg(dir).arg(QCoreApplication::applicationPid());
+    const QString path = conf.readEntry("Path", defaultPath);
+    m_maxSize = qint64(qMax(conf.readEntry("MaxSize", 256), 1)) << 20;
+
+    if (m_writer.isOpen() && m_writer.path() == path)
+        return;
+
+    m_windowIds.clear();
+    m_nextWindowId = 1;
+    m_presentTimes.clear();
+
+    if (!m_writer.open(path)) {
+        qWarning() << "Cutefish recorder: cannot write" << path;
+        return;
+    }
+
+    m_clock.start();
+
+    // Windows that already exist show up as added at the start.
+    for (KWin::EffectWindow *w : KWin::effects->stackingOrder())
+        slotWindowAdded(w);
+}
+
+quint32 RecorderEffect::windowId(KWin::EffectWindow *w)
+{
+    auto it = m_windowIds.find(w);
+    if (it == m_windowIds.end())
+        it = m_windowIds.insert(w, m_nextWindowId++);
+    return *it;
+}
+
+void RecorderEffect::write(EventLog::Event &event)
+{
+    if (!m_writer.isOpen())
+        return;
+
+    event.time = m_clock.nsecsElapsed() / 1000;
+
+    if (!m_writer.write(event) || m_writer.size() > m_maxSize) {
+        qWarning() << "Cutefish recorder: stopped at" << m_writer.size() << "bytes," << m_writer.path();
+        m_writer.close();
+    }
+}
+
+void RecorderEffect::record(EventLog::Type type, KWin::EffectWindow *w)
+{
+    EventLog::Event event;
+    event.type = type;
+    event.window = windowId(w);
+    write(event);
+}
+
+void RecorderEffect::slotWindowAdded(KWin::EffectWindow *w)
+{
+    quint32 flags = 0;
+    if (w->isNormalWindow())
+        flags |= EventLog::Normal;
+    if (w->isDialog())
+        flags |= EventLog::Dialog;
+    if (w->transientFor())
+        flags |= EventLog::Transient;
+    if (w->isPopupWindow())
+        flags |= EventLog::Popup;
+    if (w->isPopupMenu())
+        flags |= EventLog::PopupMenu;
+    if (w->isDropdownMenu())
+        flags |= EventLog::DropdownMenu;
+    if (w->isComboBox())
+        flags |= EventLog::ComboBox;
+    if (w->isTooltip())
+        flags |= EventLog::Tooltip;
+    if (w->isNotification())
+        flags |= EventLog::Notification;
+    if (w->isCriticalNotification())
+        flags |= EventLog::CriticalNotification;
+    if (w->isOnScreenDisplay())
+        flags |= EventLog::OnScreenDisplay;
+    if (w->isDock())
+        flags |= EventLog::Dock;
+    if (w->isSplash())
+        flags |= EventLog::Splash;
+    if (w->isToolbar())
+        flags |= EventLog::Toolbar;
+    if (w->isUtility())
+        flags |= EventLog::Utility;
+    if (w->isOutline())
+        flags |= EventLog::Outline;
+    if (w->isManaged())
+        flags |= EventLog::Managed;
+    if (w->hasDecoration())
+        flags |= EventLog::Decorated;
+    if (w->isX11Client())
+        flags |= EventLog::X11Client;
+
+    EventLog::Event event;
+    event.type = EventLog::WindowAdded;
+    event.window = windowId(w);
+    event.flags = flags;
+    event.geometry = w->frameGeometry();
+    event.iconGeometry = w->iconGeometry();
+    event.windowClass = w->windowClass();
+    write(event);
+}
+
+void RecorderEffect::slotWindowClosed(KWin::EffectWindow *w)
+{
+    record(EventLog::WindowClosed, w);
+}
+
+void RecorderEffect::slotWindowDeleted(KWin::EffectWindow *w)
+{
+    record(EventLog::WindowDeleted, w);
+    m_windowIds.remove(w);
+}
+
+void RecorderEffect::slotWindowMinimized(KWin::EffectWindow *w)
+{
+    record(EventLog::WindowMinimized, w);
+}
+
+void RecorderEffect::slotWindowUnminimized(KWin::EffectWindow *w)
+{
+    record(EventLog::WindowUnminimized, w);
+}
+
+void RecorderEffect::slotWindowMaximizedStateChanged(KWin::EffectWindow *w, bool horizontal, bool vertical)
+{
+    EventLog::Event event;
+    event.type = EventLog::WindowMaximized;
+    event.window = windowId(w);
+    event.value = (horizontal ? EventLog::MaximizedHorizontally : 0)
+                | (vertical ? EventLog::MaximizedVertically : 0);
+    write(event);
+}
+
+void RecorderEffect::slotWindowFrameGeometryChanged(KWin::EffectWindow *w)
+{
+    EventLog::Event event;
+    event.type = EventLog::WindowGeometry;
+    event.window = windowId(w);
+    event.geometry = w->frameGeometry();
+    write(event);
+}
+
+void RecorderEffect::prePaintScreen(KWin::ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    m_paintedWindows = 0;
+
+    // What the user sees is how long after the previous one a frame is
+    // presented on its output. The CPU time spent in the paint calls
+    // would leave out the GPU work that is still queued.
+    m_frameInterval = 0;
+    if (data.screen) {
+        auto it = m_presentTimes.find(data.screen);
+        if (it != m_presentTimes.end())
+            m_frameInterval = quint64(qMax<qint64>((presentTime - *it).count(), 0)) * 1000;
+        m_presentTimes.insert(data.screen, presentTime);
+    }
+
+    KWin::effects->prePaintScreen(data, presentTime);
+}
+
+void RecorderEffect::prePaintWindow(KWin::EffectWindow *w, KWin::WindowPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    KWin::effects->prePaintWindow(w, data, presentTime);
+
+    if (data.paint.isEmpty())
+        return;
+
+    ++m_paintedWindows;
+
+    // The part of the window repainted this frame.
+    EventLog::Event event;
+    event.type = EventLog::WindowDamaged;
+    event.window = windowId(w);
+    for (const QRect &rect : data.paint)
+        event.rects.append(rect);
+    write(event);
+}
+
+void RecorderEffect::postPaintScreen()
+{
+    KWin::effects->postPaintScreen();
+
+    // The first frame of an output has nothing to compare with.
+    if (m_frameInterval == 0)
+        return;
+
+    EventLog::Event event;
+    event.type = EventLog::Frame;
+    event.window = quint32(m_paintedWindows);
+    event.value = m_frameInterval;
+    write(event);
+}
+
+bool RecorderEffect::isActive() const
+{
+    return m_writer.isOpen();
+}
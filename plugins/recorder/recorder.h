@@ -0,0 +1,78 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <kwineffects.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+
+#include "eventlog.h"
+
+// Writes the window events and frame intervals of the session into a
+// capture (see eventlog.h) that tools/effectharness can replay. Only
+// meant to be enabled while reproducing a slowdown.
+class RecorderEffect : public KWin::Effect
+{
+    Q_OBJECT
+
+public:
+    RecorderEffect(QObject *parent = nullptr, const QVariantList &args = QVariantList());
+    ~RecorderEffect() override;
+
+    static bool supported();
+    static bool enabledByDefault();
+
+    void reconfigure(ReconfigureFlags flags) override;
+
+    void prePaintScreen(KWin::ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
+    void prePaintWindow(KWin::EffectWindow *w, KWin::WindowPrePaintData &data, std::chrono::milliseconds presentTime) override;
+    void postPaintScreen() override;
+
+    bool isActive() const override;
+    int requestedEffectChainPosition() const override { return 99; }
+
+private slots:
+    void slotWindowAdded(KWin::EffectWindow *w);
+    void slotWindowClosed(KWin::EffectWindow *w);
+    void slotWindowDeleted(KWin::EffectWindow *w);
+    void slotWindowMinimized(KWin::EffectWindow *w);
+    void slotWindowUnminimized(KWin::EffectWindow *w);
+    void slotWindowMaximizedStateChanged(KWin::EffectWindow *w, bool horizontal, bool vertical);
+    void slotWindowFrameGeometryChanged(KWin::EffectWindow *w);
+
+private:
+    quint32 windowId(KWin::EffectWindow *w);
+    void record(Cutefish::EventLog::Type type, KWin::EffectWindow *w);
+    void write(Cutefish::EventLog::Event &event);
+
+    Cutefish::EventLog::Writer m_writer;
+    QElapsedTimer m_clock;
+    QHash<const KWin::EffectWindow *, quint32> m_windowIds;
+    quint32 m_nextWindowId = 1;
+
+    QHash<const KWin::EffectScreen *, std::chrono::milliseconds> m_presentTimes;
+    quint64 m_frameInterval = 0;
+    quint64 m_paintedWindows = 0;
+    qint64 m_maxSize = 0;
+};
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "cornermask.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Rounded x / 255 for x <= 255 * 255.
+static inline quint32 div255(quint32 x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// dst = dst * c + saved * (255 - c) per channel, both premultiplied.
+static void blendScalar(quint32 *dst, const quint32 *saved, const quint8 *coverage, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const quint32 c = coverage[i];
+        const quint32 d = dst[i];
+        const quint32 s = saved[i];
+
+        quint32 result = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            const quint32 channel = ((d >> shift) & 0xff) * c + ((s >> shift) & 0xff) * (255 - c);
+            result |= div255(channel) << shift;
+        }
+        dst[i] = result;
+    }
+}
+
+#ifdef __SSE2__
+static inline __m128i blendPixelsSSE2(__m128i d, __m128i s, __m128i c)
+{
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(d, c), _mm_mullo_epi16(s, _mm_sub_epi16(full, c)));
+    x = _mm_add_epi16(x, half);
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Four pixels per iteration, the channels widened to 16 bits.
+static void blend(quint32 *dst, const quint32 *saved, const quint8 *coverage, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        int coverage4;
+        std::memcpy(&coverage4, coverage + i, sizeof(coverage4));
+
+        // c0 c1 c2 c3 -> c0 c0 c0 c0 c1 c1 c1 c1 ...
+        __m128i c = _mm_cvtsi32_si128(coverage4);
+        c = _mm_unpacklo_epi8(c, c);
+        c = _mm_unpacklo_epi16(c, c);
+
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(saved + i));
+
+        const __m128i lo = blendPixelsSSE2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(c, zero));
+        const __m128i hi = blendPixelsSSE2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(c, zero));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+    }
+
+    blendScalar(dst + i, saved + i, coverage + i, count - i);
+}
+#else
+static void blend(quint32 *dst, const quint32 *saved, const quint8 *coverage, int count)
+{
+    blendScalar(dst, saved, coverage, count);
+}
+#endif
+
+CornerMask::CornerMask(int radius)
+    : m_radius(radius)
+    , m_rows(radius)
+    , m_coverage(radius * radius)
+    , m_mirroredCoverage(radius * radius)
+    , m_saved(4 * radius * radius)
+{
+    // 4x4 samples per pixel against the arc around (radius, radius).
+    const int samples = 4;
+    const qreal r2 = qreal(radius) * radius;
+
+    for (int y = 0; y < radius; ++y) {
+        Row &row = m_rows[y];
+        row.outside = 0;
+        row.inside = radius;
+
+        for (int x = 0; x < radius; ++x) {
+            int covered = 0;
+            for (int sy = 0; sy < samples; ++sy) {
+                for (int sx = 0; sx < samples; ++sx) {
+                    const qreal dx = radius - (x + (sx + 0.5) / samples);
+                    const qreal dy = radius - (y + (sy + 0.5) / samples);
+                    if (dx * dx + dy * dy <= r2)
+                        ++covered;
+                }
+            }
+
+            const quint8 coverage = quint8((covered * 255 + samples * samples / 2) / (samples * samples));
+            m_coverage[y * radius + x] = coverage;
+            m_mirroredCoverage[y * radius + radius - 1 - x] = coverage;
+
+            if (coverage == 0)
+                row.outside = x + 1;
+            else if (coverage == 255 && row.inside == radius)
+                row.inside = x;
+        }
+    }
+}
+
+qint64 CornerMask::bytes() const
+{
+    return m_rows.size() * sizeof(Row) + m_coverage.size() + m_mirroredCoverage.size()
+        + m_saved.size() * sizeof(quint32);
+}
+
+// Calls func(corner, imageRow, maskRow, left) for every row of the four
+// corner squares that lies inside the image, left being the image
+// column of the square.
+template<typename Func>
+static void forEachCornerRow(const QImage &image, const QRect &rect, int radius, Func func)
+{
+    const int lefts[] = { rect.left(), rect.right() - radius + 1 };
+
+    for (int corner = 0; corner < 4; ++corner) {
+        const bool bottom = corner >= 2;
+        for (int y = 0; y < radius; ++y) {
+            const int imageRow = bottom ? rect.bottom() - y : rect.top() + y;
+            if (imageRow < 0 || imageRow >= image.height())
+                continue;
+
+            func(corner, imageRow, y, lefts[corner & 1]);
+        }
+    }
+}
+
+void CornerMask::save(const QImage &image, const QRect &rect)
+{
+    const int r = m_radius;
+
+    forEachCornerRow(image, rect, r, [&](int corner, int imageRow, int maskRow, int left) {
+        const int from = qMax(0, -left);
+        const int to = qMin(r, image.width() - left);
+        if (from >= to)
+            return;
+
+        const quint32 *src = reinterpret_cast<const quint32 *>(image.constScanLine(imageRow)) + left;
+        quint32 *dst = m_saved.data() + (corner * r + maskRow) * r;
+        std::memcpy(dst + from, src + from, (to - from) * sizeof(quint32));
+    });
+}
+
+void CornerMask::restore(QImage &image, const QRect &rect) const
+{
+    const int r = m_radius;
+
+    forEachCornerRow(image, rect, r, [&](int corner, int imageRow, int maskRow, int left) {
+        const bool right = corner & 1;
+        const Row &row = m_rows.at(maskRow);
+
+        // Spans in square columns, mirrored for the right corners.
+        int outsideFrom = 0, outsideTo = row.outside;
+        int blendFrom = row.outside, blendTo = row.inside;
+        if (right) {
+            outsideFrom = r - row.outside;
+            outsideTo = r;
+            blendFrom = r - row.inside;
+            blendTo = r - row.outside;
+        }
+
+        const int from = qMax(0, -left);
+        const int to = qMin(r, image.width() - left);
+
+        quint32 *dst = reinterpret_cast<quint32 *>(image.scanLine(imageRow)) + left;
+        const quint32 *saved = m_saved.constData() + (corner * r + maskRow) * r;
+        const quint8 *coverage = (right ? m_mirroredCoverage : m_coverage).constData() + maskRow * r;
+
+        outsideFrom = qMax(outsideFrom, from);
+        outsideTo = qMin(outsideTo, to);
+        if (outsideFrom < outsideTo)
+            std::memcpy(dst + outsideFrom, saved + outsideFrom, (outsideTo - outsideFrom) * sizeof(quint32));
+
+        blendFrom = qMax(blendFrom, from);
+        blendTo = qMin(blendTo, to);
+        if (blendFrom < blendTo)
+            blend(dst + blendFrom, saved + blendFrom, coverage + blendFrom, blendTo - blendFrom);
+    });
+}
@@ -0,0 +1,67 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef CORNERMASK_H
+#define CORNERMASK_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+// Antialiased rounded corners for the QPainter compositing backend,
+// where windows are painted straight into the back buffer.
+//
+// The pixels under the four corners are saved before the window is
+// painted and blended back in afterwards, weighted by how much of each
+// pixel lies outside the arc. The coverage is precomputed per radius as
+// spans per row, so only the pixels the arc passes through are blended
+// and the ones fully outside are copied back.
+class CornerMask
+{
+public:
+    explicit CornerMask(int radius);
+
+    int radius() const { return m_radius; }
+    qint64 bytes() const;
+
+    // rect is in device pixels of image, which must be 32 bits per
+    // pixel. restore() must be called with the same image and rect.
+    void save(const QImage &image, const QRect &rect);
+    void restore(QImage &image, const QRect &rect) const;
+
+private:
+    // Of a top left corner, pixels left of outside are not covered by
+    // the window, the ones from inside on fully.
+    struct Row {
+        int outside;
+        int inside;
+    };
+
+    int m_radius;
+    QVector<Row> m_rows;
+    // radius * radius coverage of the window, for the left corners and
+    // mirrored for the right ones.
+    QVector<quint8> m_coverage;
+    QVector<quint8> m_mirroredCoverage;
+    // The four corner squares, top left, top right, bottom left, bottom
+    // right.
+    QVector<quint32> m_saved;
+};
+
+#endif
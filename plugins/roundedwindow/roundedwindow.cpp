@@ -20,237 +20,343 @@
 
 #include "roundedwindow.h"
 
+// KDE
+#include <KConfigGroup>
+
+// KWin
+#if KWIN_EFFECT_API_VERSION >= 233
+#include <scene/itemrenderer.h>
+#include <scene/shadowitem.h>
+#include <scene/windowitem.h>
+#include <scene/workspacescene.h>
+#endif
+
 // Qt
 #include <QFile>
+#include <QMetaEnum>
 #include <QPainter>
 #include <QPainterPath>
 #include <QRegion>
 #include <QDebug>
+#include <QLoggingCategory>
 
 #include <QSettings>
 
+#include <cmath>
+
 Q_DECLARE_METATYPE(QPainterPath)
 
+Q_LOGGING_CATEGORY(ROUNDEDWINDOW, "cutefish.roundedwindow", QtWarningMsg)
+
 typedef void (* SetDepth)(void *, int);
 static SetDepth setDepthfunc = nullptr;
 
-static QStringList allowList = { "netease-cloud-music netease-cloud-music",
-                                 "com.alibabainc.dingtalk com.alibabainc.dingtalk",
-                                 "tenvideo_universal tenvideo_universal",
-                                 "com.eusoft.ting.en com.eusoft.ting.en",
-                                 "i4toolslinux i4tools",
-                                 "youku-app youku-app",
-                                 "qqmusic qqmusic",
-                                 "mytime mytime",
-                                 "feishu feishu",
-                                 "bytedance-feishu bytedance-feishu",
-                                 "xmind xmind",
-                                 "mtxx mtxx",
-                                 "ynote-desktop ynote-desktop",
-
-                                 // Open source software
-                                 "code code",
-                                 "motrix motrix"
-                               };
-
-// From ubreffect
-static KWin::GLShader *getShader()
-{
-    // copy from kwinglutils.cpp
-    QByteArray source;
-    QTextStream stream(&source);
-
-    KWin::GLPlatform * const gl = KWin::GLPlatform::instance();
-    QByteArray varying, output, textureLookup;
-
-    if (!gl->isGLES()) {
-        const bool glsl_140 = gl->glslVersion() >= KWin::kVersionNumber(1, 40);
-
-        if (glsl_140)
-            stream << "#version 140\n\n";
-
-        varying       = glsl_140 ? QByteArrayLiteral("in")         : QByteArrayLiteral("varying");
-        textureLookup = glsl_140 ? QByteArrayLiteral("texture")    : QByteArrayLiteral("texture2D");
-        output        = glsl_140 ? QByteArrayLiteral("fragColor")  : QByteArrayLiteral("gl_FragColor");
-    } else {
-        const bool glsl_es_300 = KWin::GLPlatform::instance()->glslVersion() >= KWin::kVersionNumber(3, 0);
+// Windows of these classes are rounded even when their type says they
+// shouldn't be. Overridden by AllowList in the [Effect-roundedwindow]
+// group of kwinrc.
+static const QStringList s_defaultAllowList = { "netease-cloud-music netease-cloud-music",
+                                                "com.alibabainc.dingtalk com.alibabainc.dingtalk",
+                                                "tenvideo_universal tenvideo_universal",
+                                                "com.eusoft.ting.en com.eusoft.ting.en",
+                                                "i4toolslinux i4tools",
+                                                "youku-app youku-app",
+                                                "qqmusic qqmusic",
+                                                "mytime mytime",
+                                                "feishu feishu",
+                                                "bytedance-feishu bytedance-feishu",
+                                                "xmind xmind",
+                                                "mtxx mtxx",
+                                                "ynote-desktop ynote-desktop",
+
+                                                // Open source software
+                                                "code code",
+                                                "motrix motrix"
+                                              };
 
-        if (glsl_es_300)
-            stream << "#version 300 es\n\n";
+RoundedWindow::RoundedWindow(QObject *, const QVariantList &)
+    : KWin::Effect()
+{
+    QSettings settings(QSettings::UserScope, "cutefishos", "theme");
+    m_devicePixelRatio = settings.value("PixelRatio", 1.0).toReal();
+    m_frameRadius = 11 * m_devicePixelRatio;
 
-        // From the GLSL ES specification:
-        //
-        //     "The fragment language has no default precision qualifier for floating point types."
-        stream << "precision highp float;\n\n";
-
-        varying       = glsl_es_300 ? QByteArrayLiteral("in")         : QByteArrayLiteral("varying");
-        textureLookup = glsl_es_300 ? QByteArrayLiteral("texture")    : QByteArrayLiteral("texture2D");
-        output        = glsl_es_300 ? QByteArrayLiteral("fragColor")  : QByteArrayLiteral("gl_FragColor");
-    }
+    setDepthfunc = (SetDepth) QLibrary::resolve("kwin.so." + qApp->applicationVersion(), "_ZN4KWin8Toplevel8setDepthEi");
 
-    KWin::ShaderTraits traits;
+    QString name = "_NET_WM_STATE";
+    xcb_intern_atom_cookie_t cookie = xcb_intern_atom_unchecked(KWin::connection(), false, name.length(), name.toUtf8());
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(KWin::connection(), cookie, nullptr);
+    m_netWMStateAtom = reply->atom;
+    free(reply);
 
-    traits |= KWin::ShaderTrait::MapTexture;
-    traits |= KWin::ShaderTrait::Modulate;
-    traits |= KWin::ShaderTrait::AdjustSaturation;
+    name = "_NET_WM_STATE_MAXIMIZED_HORZ";
+    cookie = xcb_intern_atom_unchecked(KWin::connection(), false, name.length(), name.toUtf8());
+    reply = xcb_intern_atom_reply(KWin::connection(), cookie, nullptr);
+    m_netWMStateMaxHorzAtom = reply->atom;
+    free(reply);
 
-    if (traits & KWin::ShaderTrait::MapTexture) {
-        stream << "uniform sampler2D sampler;\n";
+    name = "_NET_WM_STATE_MAXIMIZED_VERT";
+    cookie = xcb_intern_atom_unchecked(KWin::connection(), false, name.length(), name.toUtf8());
+    reply = xcb_intern_atom_reply(KWin::connection(), cookie, nullptr);
+    m_netWMStateMaxVertAtom = reply->atom;
+    free(reply);
+
+    m_painterCompositing = KWin::effects->compositingType() == KWin::QPainterCompositing;
 
-        // custom texture
-        stream << "uniform sampler2D topleft;\n";
-        stream << "uniform sampler2D topright;\n";
-        stream << "uniform sampler2D bottomleft;\n";
-        stream << "uniform sampler2D bottomright;\n";
+    if (!m_painterCompositing) {
+        m_softwareRendering = KWin::GLPlatform::instance()->isSoftwareEmulation();
+    }
 
-        // scale
-        stream << "uniform vec2 scale;\n";
-        stream << "uniform vec2 scale1;\n";
-        stream << "uniform vec2 scale2;\n";
-        stream << "uniform vec2 scale3;\n";
+    updateMaskStats();
 
-        if (traits & KWin::ShaderTrait::Modulate)
-            stream << "uniform vec4 modulation;\n";
-        if (traits & KWin::ShaderTrait::AdjustSaturation)
-            stream << "uniform float saturation;\n";
+    // Verdicts are only recomputed when the class, the type or the client
+    // side frame changes.
+    m_wmClassAtom = KWin::effects->announceSupportProperty(QByteArrayLiteral("WM_CLASS"), this);
+    m_windowTypeAtom = KWin::effects->announceSupportProperty(QByteArrayLiteral("_NET_WM_WINDOW_TYPE"), this);
+    m_gtkFrameExtentsAtom = KWin::effects->announceSupportProperty(QByteArrayLiteral("_GTK_FRAME_EXTENTS"), this);
 
-        stream << "\n" << varying << " vec2 texcoord0;\n";
+    connect(KWin::effects, &KWin::EffectsHandler::windowAdded, this, &RoundedWindow::slotWindowAdded);
+    connect(KWin::effects, &KWin::EffectsHandler::windowDeleted, this, &RoundedWindow::slotWindowDeleted);
+    connect(KWin::effects, &KWin::EffectsHandler::propertyNotify, this, &RoundedWindow::slotPropertyNotify);
+    connect(KWin::effects, &KWin::EffectsHandler::windowFrameGeometryChanged, this, &RoundedWindow::slotWindowGeometryChanged);
+    connect(KWin::effects, &KWin::EffectsHandler::windowMaximizedStateChanged, this, &RoundedWindow::slotWindowGeometryChanged);
+    connect(KWin::effects, &KWin::EffectsHandler::windowFullScreenChanged, this, &RoundedWindow::slotWindowGeometryChanged);
+    connect(KWin::effects, &KWin::EffectsHandler::windowDamaged, this, &RoundedWindow::slotWindowDamaged);
+    connect(KWin::effects, &KWin::EffectsHandler::windowActivated, this, &RoundedWindow::slotWindowActivated);
 
-    } else if (traits & KWin::ShaderTrait::UniformColor)
-        stream << "uniform vec4 geometryColor;\n";
+    reconfigure(ReconfigureAll);
+}
 
-    #if KWIN_EFFECT_API_VERSION < 233
-    if (traits & KWin::ShaderTrait::ClampTexture) {
-        stream << "uniform vec4 textureClamp;\n";
-    }
-    #endif
+RoundedWindow::~RoundedWindow()
+{
+}
+
+bool RoundedWindow::supported()
+{
+    const QByteArray desktop = qgetenv("XDG_CURRENT_DESKTOP");
+
+    if (desktop.isEmpty())
+        return false;
+
+    if (desktop != "Cutefish")
+        return false;
 
-    if (output != QByteArrayLiteral("gl_FragColor"))
-        stream << "\nout vec4 " << output << ";\n";
+    if (KWin::effects->compositingType() == KWin::QPainterCompositing)
+        return true;
 
-    stream << "\nvoid main(void)\n{\n";
-    if (traits & KWin::ShaderTrait::MapTexture) {
-        stream << "vec2 texcoordC = texcoord0;\n";
+    return KWin::effects->isOpenGLCompositing() && KWin::GLFramebuffer::supported();
+}
 
+bool RoundedWindow::enabledByDefault()
+{
+    return supported();
+}
 
-        stream << "    " << "vec4 var;\n";
-        stream << "if (texcoordC.x < 0.5) {\n"
-                  "    if (texcoordC.y < 0.5) {\n"
-                  "        vec2 cornerCoord = vec2(texcoordC.x * scale.x, texcoordC.y * scale.y);\n"
-                  "        var = " << textureLookup << "(topleft, cornerCoord);\n"
-                  "    } else {\n"
-                  "        vec2 cornerCoordBL = vec2(texcoordC.x * scale2.x, (1.0 - texcoordC.y) * scale2.y);\n"
-                  "        var = " << textureLookup << "(bottomleft, cornerCoordBL);\n"
-                  "    }\n"
-                  "} else {\n"
-                  "    if (texcoordC.y < 0.5) {\n"
-                  "        vec2 cornerCoordTR = vec2((1.0 - texcoordC.x) * scale1.x, texcoordC.y * scale1.y);\n"
-                  "        var = " << textureLookup << "(topright, cornerCoordTR);\n"
-                  "    } else {\n"
-                  "        vec2 cornerCoordBR = vec2((1.0 - texcoordC.x) * scale3.x, (1.0 - texcoordC.y) * scale3.y);\n"
-                  "        var = " << textureLookup << "(bottomright, cornerCoordBR);\n"
-                  "    }\n"
-                  "}\n";
+void RoundedWindow::reconfigure(ReconfigureFlags flags)
+{
+    Q_UNUSED(flags)
+
+    KConfigGroup conf = KWin::effects->effectConfig(QStringLiteral("roundedwindow"));
+    m_allowList.load(conf, "AllowList", s_defaultAllowList);
+
+    m_cacheStaticWindows = conf.readEntry("CacheStaticWindows", false);
+    m_cacheBudget = qint64(qMax(conf.readEntry("CacheBudget", 128), 0)) << 20;
+
+    m_adaptiveQuality = conf.readEntry("AdaptiveQuality", true);
+    m_qualityTier = FullQuality;
+    m_averageInterval = 1.0;
+    m_presentTimes.clear();
+    m_framesInTier = 0;
+
+    m_cacheStats.evicted(m_cachedWindows.size());
+    m_cachedWindows.clear();
+    m_damagedFrames.clear();
+    m_cacheBytes = 0;
+    updateCacheStats();
+
+    m_windowFlags.clear();
+    for (KWin::EffectWindow *w : KWin::effects->stackingOrder()) {
+        m_windowFlags.insert(w, classify(w));
+        updateClipRegion(w);
+    }
+}
 
-        stream << "    vec4 texel = " << textureLookup << "(sampler, texcoordC);\n";
-        if (traits & KWin::ShaderTrait::Modulate)
-            stream << "    texel *= modulation;\n";
-        if (traits & KWin::ShaderTrait::AdjustSaturation)
-            stream << "    texel.rgb = mix(vec3(dot(texel.rgb, vec3(0.2126, 0.7152, 0.0722))), texel.rgb, saturation);\n";
+void RoundedWindow::slotWindowAdded(KWin::EffectWindow *w)
+{
+    m_windowFlags.insert(w, classify(w));
+    updateClipRegion(w);
+}
 
-        stream << "    " << output << " = texel * var;\n";
-    } else if (traits & KWin::ShaderTrait::UniformColor)
-        stream << "    " << output << " = geometryColor;\n";
+void RoundedWindow::slotWindowDeleted(KWin::EffectWindow *w)
+{
+    m_windowFlags.remove(w);
+    m_damagedFrames.remove(w);
+    releaseCachedWindow(w);
+}
 
-    stream << "}";
-    stream.flush();
+void RoundedWindow::slotPropertyNotify(KWin::EffectWindow *w, long atom)
+{
+    if (w && (atom == m_wmClassAtom || atom == m_windowTypeAtom || atom == m_gtkFrameExtentsAtom)) {
+        m_windowFlags.insert(w, classify(w));
+        updateClipRegion(w);
+    }
+}
 
-    auto shader = KWin::ShaderManager::instance()->generateCustomShader(traits, QByteArray(), source);
+void RoundedWindow::slotWindowGeometryChanged(KWin::EffectWindow *w)
+{
+    // Wayland clients announce their shadow margins through the buffer
+    // geometry, which only changes together with the frame.
+    if (!w->isX11Client() && !w->hasDecoration()) {
+        const int flags = classify(w);
+        if (flags != m_windowFlags.value(w, -1))
+            m_windowFlags.insert(w, flags);
+    }
 
-    //shaders.insert(direction, shader);
-    return shader.get();
+    updateClipRegion(w);
+    slotWindowDamaged(w);
 }
 
-static KWin::GLTexture *getTexture(int borderRadius)
+void RoundedWindow::slotWindowDamaged(KWin::EffectWindow *w)
 {
-    QPixmap pix(QSize(borderRadius, borderRadius));
-    pix.fill(Qt::transparent);
-    QPainter painter(&pix);
-    painter.setRenderHint(QPainter::Antialiasing);
-    QPainterPath path;
-    path.moveTo(borderRadius, 0);
-    path.arcTo(0, 0, 2 * borderRadius, 2 * borderRadius, 90, 90);
-    path.lineTo(borderRadius, borderRadius);
-    path.lineTo(borderRadius, 0);
-    painter.fillPath(path, Qt::white);
+    if (m_cacheStaticWindows)
+        m_damagedFrames.insert(w, m_frame);
 
-    auto texture = new KWin::GLTexture(pix);
-    texture->setFilter(GL_LINEAR);
-    texture->setWrapMode(GL_CLAMP_TO_BORDER);
+    auto it = m_cachedWindows.find(w);
+    if (it != m_cachedWindows.end())
+        it->second.dirty = true;
+}
 
-    return texture;
+void RoundedWindow::slotWindowActivated(KWin::EffectWindow *w)
+{
+    Q_UNUSED(w)
+
+    // The decoration of both the old and the new active window changes
+    // without damaging the client.
+    for (auto &cached : m_cachedWindows)
+        cached.second.dirty = true;
 }
 
-RoundedWindow::RoundedWindow(QObject *, const QVariantList &)
-    : KWin::Effect()
+QRegion RoundedWindow::clipRegion(const QSize &size)
 {
-    QSettings settings(QSettings::UserScope, "cutefishos", "theme");
-    qreal devicePixelRatio = settings.value("PixelRatio", 1.0).toReal();
-    m_frameRadius = 11 * devicePixelRatio;
+    const quint64 key = (quint64(quint16(size.width())) << 48)
+            | (quint64(quint16(size.height())) << 32)
+            | (quint64(quint16(m_frameRadius)) << 16)
+            | quint64(quint16(qRound(m_devicePixelRatio * 100)));
+
+    auto it = m_clipRegions.constFind(key);
+    if (it != m_clipRegions.constEnd()) {
+        m_clipRegionStats.hit();
+        return *it;
+    }
 
-    setDepthfunc = (SetDepth) QLibrary::resolve("kwin.so." + qApp->applicationVersion(), "_ZN4KWin8Toplevel8setDepthEi");
+    m_clipRegionStats.miss();
+    if (m_clipRegions.size() >= 64) {
+        m_clipRegionStats.evicted(m_clipRegions.size());
+        m_clipRegions.clear();
+    }
 
-    QString name = "_NET_WM_STATE";
-    xcb_intern_atom_cookie_t cookie = xcb_intern_atom_unchecked(KWin::connection(), false, name.length(), name.toUtf8());
-    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(KWin::connection(), cookie, nullptr);
-    m_netWMStateAtom = reply->atom;
-    free(reply);
+    // One rectangle per corner scanline, inset by where the arc crosses
+    // the middle of the row, plus the straight part in between.
+    const int radius = qMin(m_frameRadius, qMin(size.width(), size.height()) / 2);
+    QRegion region(0, radius, size.width(), size.height() - 2 * radius);
 
-    name = "_NET_WM_STATE_MAXIMIZED_HORZ";
-    cookie = xcb_intern_atom_unchecked(KWin::connection(), false, name.length(), name.toUtf8());
-    reply = xcb_intern_atom_reply(KWin::connection(), cookie, nullptr);
-    m_netWMStateMaxHorzAtom = reply->atom;
-    free(reply);
+    for (int y = 0; y < radius; ++y) {
+        const qreal dy = radius - y - 0.5;
+        const int inset = qRound(radius - std::sqrt(qMax<qreal>(0.0, radius * radius - dy * dy)));
+        const int width = size.width() - 2 * inset;
 
-    name = "_NET_WM_STATE_MAXIMIZED_VERT";
-    cookie = xcb_intern_atom_unchecked(KWin::connection(), false, name.length(), name.toUtf8());
-    reply = xcb_intern_atom_reply(KWin::connection(), cookie, nullptr);
-    m_netWMStateMaxVertAtom = reply->atom;
-    free(reply);
+        region += QRect(inset, y, width, 1);
+        region += QRect(inset, size.height() - 1 - y, width, 1);
+    }
+
+    m_clipRegions.insert(key, region);
+
+    qint64 bytes = 0;
+    for (const QRegion &cached : std::as_const(m_clipRegions))
+        bytes += cached.rectCount() * sizeof(QRect);
+    m_clipRegionStats.setUsage(m_clipRegions.size(), bytes);
 
-    m_shader = getShader();
-    m_texure = getTexture(m_frameRadius);
+    return region;
 }
 
-RoundedWindow::~RoundedWindow()
+void RoundedWindow::updateClipRegion(KWin::EffectWindow *w)
 {
+    if (!(windowFlags(w) & RoundCorners) || w->isFullScreen() || isMaximized(w))
+        w->setData(WindowClipPathRole, QVariant());
+    else
+        w->setData(WindowClipPathRole, QVariant::fromValue(clipRegion(w->size())));
 }
 
-bool RoundedWindow::supported()
+int RoundedWindow::classify(KWin::EffectWindow *w) const
 {
-    const QByteArray desktop = qgetenv("XDG_CURRENT_DESKTOP");
+    int flags = 0;
 
-    if (desktop.isEmpty())
+    if (m_allowList.contains(w->windowClass()))
+        flags |= AllowListed;
+
+    // Masking those again cuts their own shadow at the corners, and the
+    // allow list is about window types, not about them.
+    if (isClientDecorated(w))
+        return flags | ClientDecorated;
+
+    const bool special = w->isDesktop()
+            || w->isMenu()
+            || w->isDock()
+            || w->isPopupWindow()
+            || w->isPopupMenu();
+
+    if (!special || (flags & AllowListed))
+        flags |= RoundCorners;
+
+    return flags;
+}
+
+bool RoundedWindow::isClientDecorated(KWin::EffectWindow *w) const
+{
+    if (w->hasDecoration())
         return false;
 
-    return desktop == "Cutefish" && KWin::effects->isOpenGLCompositing() && KWin::GLFramebuffer::supported();
+    // X11 clients put the size of their shadow around the visible frame
+    // in _GTK_FRAME_EXTENTS (left, right, top, bottom).
+    if (w->isX11Client()) {
+        const QByteArray extents = w->readProperty(m_gtkFrameExtentsAtom, XCB_ATOM_CARDINAL, 32);
+        if (extents.size() < int(4 * sizeof(quint32)))
+            return false;
+
+        const quint32 *values = reinterpret_cast<const quint32 *>(extents.constData());
+        return values[0] || values[1] || values[2] || values[3];
+    }
+
+    // Wayland clients set a window geometry inside a larger buffer.
+    return w->bufferGeometry() != w->frameGeometry()
+            && w->bufferGeometry().contains(w->frameGeometry());
 }
 
-bool RoundedWindow::enabledByDefault()
+int RoundedWindow::windowFlags(KWin::EffectWindow *w)
 {
-    return supported();
+    auto it = m_windowFlags.constFind(w);
+    if (it != m_windowFlags.constEnd())
+        return *it;
+
+    return *m_windowFlags.insert(w, classify(w));
 }
 
-#if KWIN_EFFECT_API_VERSION < 233
-bool RoundedWindow::hasShadow(KWin::WindowQuadList &qds)
+bool RoundedWindow::hasShadow(KWin::EffectWindow *w, const KWin::WindowPaintData &data) const
 {
-    for (int i = 0; i < qds.count(); ++i)
-        if (qds.at(i).type() == KWin::WindowQuadShadow)
+#if KWIN_EFFECT_API_VERSION < 233
+    Q_UNUSED(w)
+
+    for (int i = 0; i < data.quads.count(); ++i)
+        if (data.quads.at(i).type() == KWin::WindowQuadShadow)
             return true;
 
     return false;
-}
+#else
+    Q_UNUSED(data)
+
+    const KWin::WindowItem *item = w->windowItem();
+    return item && item->shadowItem() && item->shadowItem()->isVisible();
 #endif
+}
 
 bool RoundedWindow::isMaximized(KWin::EffectWindow *w)
 {
@@ -269,8 +375,79 @@ bool RoundedWindow::isMaximized(KWin::EffectWindow *w)
     return false;
 }
 
+void RoundedWindow::prePaintScreen(KWin::ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    m_stencilFramebuffer = -1;
+    ++m_frame;
+
+    // Frames that miss their vblank are presented a refresh interval or
+    // more after the previous one. Every output has its own clock, and a
+    // gap of several intervals is an idle output rather than an overrun.
+    if (m_adaptiveQuality && data.screen) {
+        const std::chrono::milliseconds previous = m_presentTimes.value(data.screen, presentTime);
+        m_presentTimes.insert(data.screen, presentTime);
+
+        const qreal interval = 1000000.0 / qMax(data.screen->refreshRate(), 1000);
+        const qreal delta = (presentTime - previous).count();
+        if (delta > 0 && delta < 4 * interval)
+            updateQualityTier(delta / interval);
+    }
+
+    KWin::effects->prePaintScreen(data, presentTime);
+}
+
+void RoundedWindow::updateQualityTier(qreal intervals)
+{
+    m_averageInterval += (intervals - m_averageInterval) * 0.1;
+    ++m_framesInTier;
+
+    QualityTier tier = m_qualityTier;
+    if (m_framesInTier >= 30 && m_averageInterval > 1.2 && tier < Bypass)
+        tier = QualityTier(tier + 1);
+    else if (m_framesInTier >= 120 && m_averageInterval < 1.05 && tier > FullQuality)
+        tier = QualityTier(tier - 1);
+
+    if (tier == m_qualityTier)
+        return;
+
+    qCDebug(ROUNDEDWINDOW) << "Quality tier" << tier << "at" << m_averageInterval << "refresh intervals per frame";
+
+    m_qualityTier = tier;
+    m_framesInTier = 0;
+
+    // Only the active window is drawn through the offscreen copies from
+    // here on, give the others' memory back.
+    if (tier > FullQuality) {
+        const KWin::EffectWindow *active = KWin::effects->activeWindow();
+        for (auto it = m_cachedWindows.begin(); it != m_cachedWindows.end();) {
+            if (it->first == active) {
+                ++it;
+                continue;
+            }
+            m_cacheBytes -= it->second.bytes;
+            it = m_cachedWindows.erase(it);
+            m_cacheStats.evicted();
+        }
+        updateCacheStats();
+    }
+
+    KWin::effects->addRepaintFull();
+}
+
+QString RoundedWindow::debug(const QString &parameter) const
+{
+    if (parameter != QLatin1String("tier"))
+        return QString();
+
+    return QStringLiteral("%1, %2 refresh intervals per frame")
+            .arg(QLatin1String(QMetaEnum::fromType<QualityTier>().valueToKey(m_qualityTier)))
+            .arg(m_averageInterval, 0, 'f', 2);
+}
+
 void RoundedWindow::drawWindow(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data)
 {
+    CUTEFISH_TRACE_SCOPE("RoundedWindow::drawWindow");
+
     // TO-DO:目前只为编译通过进行更改
     // if (!w->isPaintingEnabled() || ((mask & PAINT_WINDOW_LANCZOS))) {
     //     return KWin::Effect::drawWindow(w, mask, region, data);
@@ -280,101 +457,700 @@ void RoundedWindow::drawWindow(KWin::EffectWindow *w, int mask, const QRegion &r
         return KWin::Effect::drawWindow(w, mask, region, data);
     }
 
-    if (KWin::effects->hasActiveFullScreenEffect() || w->isFullScreen()) {
+    // Full screen effects such as present windows draw scaled windows,
+    // those keep their corners at the scaled radius.
+    if (w->isFullScreen()) {
         return KWin::Effect::drawWindow(w, mask, region, data);
     }
 
-    if (w->isDesktop()
-            || w->isMenu()
-            || w->isDock()
-            || w->isPopupWindow()
-            || w->isPopupMenu()
-            #if KWIN_EFFECT_API_VERSION < 233
-                 || !hasShadow(data.quads)
-            #endif
-        ) {
-        if (!allowList.contains(w->windowClass()))
+    const int flags = windowFlags(w);
+
+    if (!(flags & RoundCorners))
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    if (!(flags & AllowListed) && !hasShadow(w, data))
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    if (m_qualityTier != FullQuality && w != KWin::effects->activeWindow()) {
+        if (m_qualityTier >= ActiveOnly)
             return KWin::Effect::drawWindow(w, mask, region, data);
+
+        if (m_painterCompositing)
+            return drawWindowClipped(w, mask, region, data);
+        if (hasStencil())
+            return drawWindowStencilled(w, mask, region, data);
+
+        return drawWindowBlended(w, mask, region, data, true);
     }
 
-    // TO-DO:目前只为编译通过进行更改
-    // // 设置 alpha 通道混合
-    // if (!w->hasAlpha()) {
-    //     if (setDepthfunc) {
-    //         setDepthfunc(w->parent(), 32);
-    //     }
-    // }
+    if (m_qualityTier == Bypass)
+        return KWin::Effect::drawWindow(w, mask, region, data);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    float borderColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
-
-    auto textureTopLeft = m_texure;
-    glActiveTexture(GL_TEXTURE10);
-    textureTopLeft->bind();
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    glActiveTexture(GL_TEXTURE0);
-
-    auto textureTopRight = m_texure;
-    glActiveTexture(GL_TEXTURE11);
-    textureTopRight->bind();
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    glActiveTexture(GL_TEXTURE0);
-
-    auto textureBottomLeft = m_texure;
-    glActiveTexture(GL_TEXTURE12);
-    textureBottomLeft->bind();
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    glActiveTexture(GL_TEXTURE0);
-
-    auto textureBottomRight = m_texure;
-    glActiveTexture(GL_TEXTURE13);
-    textureBottomRight->bind();
-    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
-    glActiveTexture(GL_TEXTURE0);
+    if (m_painterCompositing)
+        return drawWindowPainted(w, mask, region, data);
 
-    // TO-DO:目前只为编译通过进行更改
-    // KWin::GLShader *oldShader = data.shader;
-    // data.shader = m_shader;
-    // KWin::ShaderManager::instance()->pushShader(m_shader);
+    // Without a stencil buffer the software rasterizer takes the corner
+    // pass like everyone else.
+    if (m_softwareRendering && hasStencil())
+        return drawWindowStencilled(w, mask, region, data);
+
+    if (m_cacheStaticWindows && drawWindowCached(w, mask, region, data))
+        return;
+
+    drawWindowBlended(w, mask, region, data);
+}
+
+// The corner squares of rect, top left, top right, bottom left and
+// bottom right, as the framebuffer pixel (origin bottom left) of their
+// lower left end. The framebuffer shows viewport at scale.
+static void cornerSquares(const QRectF &rect, int size, const QRectF &viewport, qreal scale, QPoint squares[4])
+{
+    const QPointF origins[] = { rect.topLeft(), rect.topRight(), rect.bottomLeft(), rect.bottomRight() };
+
+    for (int i = 0; i < 4; ++i) {
+        const QPointF corner = origins[i] - viewport.topLeft();
+        const int x = std::floor(corner.x() * scale) - (i % 2 ? size : 0);
+        const int y = std::floor((viewport.height() - corner.y()) * scale) - (i < 2 ? size : 0);
+        squares[i] = QPoint(x, y);
+    }
+}
+
+// The corner squares of rect that lose the area outside their arc, in
+// the coordinates the window is drawn at.
+static QRegion cornerRegion(const QRectF &rect, qreal radius)
+{
+    const QSizeF size(radius, radius);
+
+    QRegion region;
+    region += QRectF(rect.topLeft(), size).toAlignedRect();
+    region += QRectF(rect.topRight() - QPointF(radius, 0), size).toAlignedRect();
+    region += QRectF(rect.bottomLeft() - QPointF(0, radius), size).toAlignedRect();
+    region += QRectF(rect.bottomRight() - QPointF(radius, radius), size).toAlignedRect();
+    return region;
+}
+
+// The decoration shadow reaches under the frame and is already cut to
+// the rounded shape, so it must not lose its corners with the window.
+// Draws the shadow on its own before the corners are saved or
+// stencilled, so that what is put back there already contains it.
+//
+// With window quads only the rest of the window is left in the paint
+// data until the pass goes out of scope. The item based scene (effect
+// API 233 on) draws the shadow item with the window again, so there it
+// is only drawn ahead inside the corner squares, where the window
+// covers the second copy or the cut puts the first one back.
+class ShadowPass
+{
+public:
+    ShadowPass(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data,
+               const QRegion &corners)
+        : m_data(data)
+    {
+#if KWIN_EFFECT_API_VERSION < 233
+        Q_UNUSED(corners)
+
+        m_quads = data.quads;
+        data.quads = m_quads.select(KWin::WindowQuadShadow);
+        if (!data.quads.isEmpty())
+            KWin::effects->drawWindow(w, mask, region, data);
+        data.quads = m_quads.filterOut(KWin::WindowQuadShadow);
+#else
+        KWin::WindowItem *item = w->windowItem();
+        KWin::ShadowItem *shadow = item ? item->shadowItem() : nullptr;
+        if (!shadow || !shadow->isVisible())
+            return;
+
+        const QRegion clip = region & corners;
+        if (clip.isEmpty())
+            return;
+
+        // The renderer starts at the item it is given, the shadow item
+        // sits relative to the window one.
+        KWin::WindowPaintData shadowData = data;
+        shadowData.translate(item->position().x(), item->position().y());
+        KWin::effects->scene()->renderer()->renderItem(shadow, mask, clip, shadowData);
+#endif
+    }
+
+    ~ShadowPass()
+    {
+#if KWIN_EFFECT_API_VERSION < 233
+        m_data.quads = m_quads;
+#endif
+    }
+
+private:
+    KWin::WindowPaintData &m_data;
+#if KWIN_EFFECT_API_VERSION < 233
+    KWin::WindowQuadList m_quads;
+#endif
+};
+
+bool RoundedWindow::hasStencil()
+{
+    // KWin renders into its own framebuffer objects as well, ask the one
+    // that is bound rather than the default framebuffer.
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    if (framebuffer == m_stencilFramebuffer)
+        return m_hasStencil;
+
+    const GLenum attachment = framebuffer ? GL_STENCIL_ATTACHMENT : GL_STENCIL;
+    GLint type = GL_NONE;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+
+    GLint bits = 0;
+    if (type != GL_NONE)
+        glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, attachment, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &bits);
+
+    m_stencilFramebuffer = framebuffer;
+    m_hasStencil = bits > 0;
+    return m_hasStencil;
+}
+
+KWin::GLVertexBuffer *RoundedWindow::cornerBuffer()
+{
+    if (m_cornerBuffer)
+        return m_cornerBuffer.get();
+
+    // The area outside the arc of a top left corner, in units of the
+    // radius: a fan of triangles from the corner point to the arc.
+    const int segments = 16;
+    QVector<float> vertices;
+    vertices.reserve(segments * 6);
+
+    for (int i = 0; i < segments; ++i) {
+        const qreal a0 = M_PI_2 * i / segments;
+        const qreal a1 = M_PI_2 * (i + 1) / segments;
+
+        vertices << 0.0f << 0.0f
+                 << float(1.0 - std::cos(a0)) << float(1.0 - std::sin(a0))
+                 << float(1.0 - std::cos(a1)) << float(1.0 - std::sin(a1));
+    }
+
+    m_cornerBuffer.reset(new KWin::GLVertexBuffer(KWin::GLVertexBuffer::Static));
+    m_cornerBuffer->setData(vertices.size() / 2, 2, vertices.constData(), nullptr);
+    updateMaskStats();
+
+    return m_cornerBuffer.get();
+}
+
+void RoundedWindow::drawWindowStencilled(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data)
+{
+    CUTEFISH_TRACE_SCOPE("RoundedWindow::drawWindowStencilled");
+
+    const QRect geometry = w->frameGeometry();
+    const QRectF rect(geometry.x() + data.xTranslation(),
+                      geometry.y() + data.yTranslation(),
+                      geometry.width() * data.xScale(),
+                      geometry.height() * data.yScale());
+    const qreal radius = qMin<qreal>(m_frameRadius * qMin(data.xScale(), data.yScale()),
+                                     qMin(rect.width(), rect.height()) / 2);
+
+    if (radius < 1.0)
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    // Corner origins, and the direction the corner grows into the window.
+    const QPointF origins[] = { rect.topLeft(), rect.topRight(), rect.bottomLeft(), rect.bottomRight() };
+    const QPointF directions[] = { QPointF(1, 1), QPointF(-1, 1), QPointF(1, -1), QPointF(-1, -1) };
+
+    const ShadowPass shadow(w, mask, region, data, cornerRegion(rect, radius));
+
+    // 1. Mark the pixels outside of the rounded corners.
+    glEnable(GL_STENCIL_TEST);
+    glStencilMask(0xff);
+    glStencilFunc(GL_ALWAYS, 1, 0xff);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    {
+        KWin::ShaderBinder binder(KWin::ShaderTrait::UniformColor);
+        KWin::GLVertexBuffer *corner = cornerBuffer();
+
+        corner->bindArrays();
+        for (int i = 0; i < 4; ++i) {
+            QMatrix4x4 matrix = data.screenProjectionMatrix();
+            matrix.translate(origins[i].x(), origins[i].y());
+            matrix.scale(radius * directions[i].x(), radius * directions[i].y());
+
+            binder.shader()->setUniform(KWin::GLShader::ModelViewProjectionMatrix, matrix);
+            corner->draw(GL_TRIANGLES, 0, corner->vertexCount());
+        }
+        corner->unbindArrays();
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+    // 2. The window itself goes through the stock pipeline, everything
+    //    but the corners passes the stencil test untouched.
+    glStencilFunc(GL_NOTEQUAL, 1, 0xff);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+    KWin::Effect::drawWindow(w, mask, region, data);
+
+    // 3. Reset the stencil, only in the four corner squares.
+    const qreal scale = KWin::effects->renderTargetScale();
+    const int size = std::ceil(radius * scale);
+    QPoint squares[4];
+    cornerSquares(rect, size, KWin::effects->renderTargetRect(), scale, squares);
+
+    GLint scissorBox[4];
+    const GLboolean scissorEnabled = glIsEnabled(GL_SCISSOR_TEST);
+    glGetIntegerv(GL_SCISSOR_BOX, scissorBox);
+    glEnable(GL_SCISSOR_TEST);
+
+    for (const QPoint &square : squares) {
+        glScissor(square.x(), square.y(), size, size);
+        glClear(GL_STENCIL_BUFFER_BIT);
+    }
+
+    glScissor(scissorBox[0], scissorBox[1], scissorBox[2], scissorBox[3]);
+    if (!scissorEnabled)
+        glDisable(GL_SCISSOR_TEST);
+
+    glDisable(GL_STENCIL_TEST);
+}
+
+void RoundedWindow::drawWindowPainted(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data)
+{
+    CUTEFISH_TRACE_SCOPE("RoundedWindow::drawWindowPainted");
+
+    QPainter *painter = KWin::effects->scenePainter();
+    QImage *target = painter ? dynamic_cast<QImage *>(painter->device()) : nullptr;
+
+    if (!target || target->depth() != 32)
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    // Rotated windows have no axis aligned corners to cut.
+    const QTransform transform = painter->deviceTransform();
+    if (transform.type() > QTransform::TxScale || data.rotationAngle() != 0.0)
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    // Scaled windows get a mask at their on-screen radius, so the cost
+    // follows the size they are drawn at.
+    const QRect geometry = w->frameGeometry();
+    const QRectF rect(geometry.x() + data.xTranslation(),
+                      geometry.y() + data.yTranslation(),
+                      geometry.width() * data.xScale(),
+                      geometry.height() * data.yScale());
+    const QRect deviceRect = transform.mapRect(rect).toAlignedRect();
+    const int radius = qRound(m_frameRadius * qMin(data.xScale(), data.yScale()) * transform.m11());
+
+    if (radius < 1 || 2 * radius > qMin(deviceRect.width(), deviceRect.height()))
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    if (!m_cornerMask || m_cornerMask->radius() != radius) {
+        m_cornerMask.reset(new CornerMask(radius));
+        updateMaskStats();
+    }
+
+    // The shadow goes under the saved pixels, so they bring it back.
+    const ShadowPass shadow(w, mask, region, data, cornerRegion(rect, m_frameRadius * qMin(data.xScale(), data.yScale())));
+
+    m_cornerMask->save(*target, deviceRect);
+    KWin::Effect::drawWindow(w, mask, region, data);
+    m_cornerMask->restore(*target, deviceRect);
+}
+
+void RoundedWindow::drawWindowClipped(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data)
+{
+    CUTEFISH_TRACE_SCOPE("RoundedWindow::drawWindowClipped");
+
+    QPainter *painter = KWin::effects->scenePainter();
+    if (!painter || data.rotationAngle() != 0.0)
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    // Aliased corners: everything but the area outside the arcs.
+    const QRect frame = w->frameGeometry();
+    const QRectF rect(frame.x() + data.xTranslation(),
+                      frame.y() + data.yTranslation(),
+                      frame.width() * data.xScale(),
+                      frame.height() * data.yScale());
+
+    const ShadowPass shadow(w, mask, region, data, cornerRegion(rect, m_frameRadius * qMin(data.xScale(), data.yScale())));
+
+    const QRect expanded = w->expandedGeometry().translated(-frame.topLeft());
+    const QRegion corners = QRegion(0, 0, frame.width(), frame.height()) - clipRegion(frame.size());
+
+    painter->save();
+
+    const QTransform transform = painter->transform();
+    painter->translate(frame.x() + data.xTranslation(), frame.y() + data.yTranslation());
+    painter->scale(data.xScale(), data.yScale());
+    painter->setClipRegion(QRegion(expanded) - corners, Qt::IntersectClip);
+    painter->setTransform(transform);
+
+    KWin::Effect::drawWindow(w, mask, region, data);
+
+    painter->restore();
+}
+
+static void renderQuad(const QRectF &rect, const QRectF &texRect)
+{
+    const float vertices[] = {
+        float(rect.left()),  float(rect.top()),
+        float(rect.right()), float(rect.top()),
+        float(rect.right()), float(rect.bottom()),
+        float(rect.right()), float(rect.bottom()),
+        float(rect.left()),  float(rect.bottom()),
+        float(rect.left()),  float(rect.top())
+    };
+
+    const float texcoords[] = {
+        float(texRect.left()),  float(texRect.top()),
+        float(texRect.right()), float(texRect.top()),
+        float(texRect.right()), float(texRect.bottom()),
+        float(texRect.right()), float(texRect.bottom()),
+        float(texRect.left()),  float(texRect.bottom()),
+        float(texRect.left()),  float(texRect.top())
+    };
+
+    KWin::GLVertexBuffer *vbo = KWin::GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setData(6, 2, vertices, texcoords);
+    vbo->render(GL_TRIANGLES);
+}
+
+KWin::GLShader *RoundedWindow::cornerShader()
+{
+    if (!m_cornerShader) {
+        const bool glsl140 = KWin::GLPlatform::instance()->glslVersion() >= KWin::kVersionNumber(1, 40);
+        m_cornerShader = KWin::ShaderManager::instance()->generateShaderFromFile(
+                    KWin::ShaderTrait::MapTexture, QString(),
+                    glsl140 ? QStringLiteral(":/shaders.frag.140") : QStringLiteral(":/shaders.frag.110"));
+    }
+
+    return m_cornerShader && m_cornerShader->isValid() ? m_cornerShader.get() : nullptr;
+}
+
+void RoundedWindow::drawCutWindow(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data,
+                                  const QRectF &rect, qreal radius, const QRectF &viewport, qreal scale,
+                                  const QMatrix4x4 &projection, bool aliased)
+{
+    KWin::GLShader *shader = cornerShader();
+    if (!shader)
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    const int size = std::ceil(radius * scale);
+    QPoint squares[4];
+    cornerSquares(rect, size, viewport, scale, squares);
+
+    // The four corners before the window is drawn on the left half, the
+    // same pixels after it on the right one.
+    if (!m_cornerAtlas || m_cornerAtlas->width() < 4 * size || m_cornerAtlas->height() < 2 * size) {
+        m_cornerAtlas.reset(new KWin::GLTexture(GL_RGBA8, QSize(4 * size, 2 * size)));
+        m_cornerAtlas->setFilter(GL_NEAREST);
+        m_cornerAtlas->setWrapMode(GL_CLAMP_TO_EDGE);
+        updateMaskStats();
+    }
+
+    const int half = m_cornerAtlas->width() / 2;
+    auto copyCorners = [&](int offset) {
+        m_cornerAtlas->bind();
+        for (int i = 0; i < 4; ++i) {
+            glCopyTexSubImage2D(GL_TEXTURE_2D, 0, offset + (i % 2) * size, (i / 2) * size,
+                                squares[i].x(), squares[i].y(), size, size);
+        }
+        m_cornerAtlas->unbind();
+    };
+
+    {
+        const ShadowPass shadow(w, mask, region, data, cornerRegion(rect, radius));
+
+        copyCorners(0);
+        KWin::Effect::drawWindow(w, mask, region, data);
+        if (!aliased)
+            copyCorners(half);
+    }
+
+    // Mix the two back in by how much of each pixel lies outside the
+    // arc, see shaders.frag.140. The window is drawn once, only the
+    // corner squares are touched a second time. Aliased corners only
+    // put the background back where the pixel center is outside.
+    const QPointF centers[] = {
+        rect.topLeft() + QPointF(radius, radius),
+        rect.topRight() + QPointF(-radius, radius),
+        rect.bottomLeft() + QPointF(radius, -radius),
+        rect.bottomRight() + QPointF(-radius, -radius)
+    };
+    const qreal atlasWidth = m_cornerAtlas->width();
+    const qreal atlasHeight = m_cornerAtlas->height();
+
+    glDisable(GL_BLEND);
+
+    KWin::ShaderBinder binder(shader);
+    shader->setUniform(KWin::GLShader::ModelViewProjectionMatrix, projection);
+    shader->setUniform(KWin::GLShader::TextureMatrix, QMatrix4x4());
+    shader->setUniform("windowOffset", QVector2D(half / atlasWidth, 0.0f));
+    shader->setUniform("radius", float(radius * scale));
+    shader->setUniform("aliased", aliased ? 1 : 0);
+
+    m_cornerAtlas->bind();
+    for (int i = 0; i < 4; ++i) {
+        const QPointF center = centers[i] - viewport.topLeft();
+        shader->setUniform("center", QVector2D(center.x() * scale, (viewport.height() - center.y()) * scale));
+
+        const QRectF target(viewport.x() + squares[i].x() / scale,
+                            viewport.y() + viewport.height() - (squares[i].y() + size) / scale,
+                            size / scale, size / scale);
+        // Framebuffer rows go up, the top of the quad is the last row.
+        const QRectF texRect(((i % 2) * size) / atlasWidth, ((i / 2) * size + size) / atlasHeight,
+                             size / atlasWidth, -size / atlasHeight);
+        renderQuad(target, texRect);
+    }
+    m_cornerAtlas->unbind();
+}
 
-    // m_shader->setUniform("topleft", 10);
-    // m_shader->setUniform("scale", QVector2D(w->width() * 1.0 / textureTopLeft->width(),
-    //                                            w->height() * 1.0 / textureTopLeft->height()));
+void RoundedWindow::drawWindowBlended(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data,
+                                      bool aliased)
+{
+    CUTEFISH_TRACE_SCOPE("RoundedWindow::drawWindowBlended");
 
-    // m_shader->setUniform("topright", 11);
-    // m_shader->setUniform("scale1", QVector2D(w->width() * 1.0 / textureTopRight->width(),
-    //                                             w->height() * 1.0 / textureTopRight->height()));
+    // Rotations and 3D transforms have no axis aligned corners to cut.
+    if (data.rotationAngle() != 0.0 || data.zScale() != 1.0)
+        return KWin::Effect::drawWindow(w, mask, region, data);
 
-    // m_shader->setUniform("bottomleft", 12);
-    // m_shader->setUniform("scale2", QVector2D(w->width() * 1.0 / textureBottomLeft->width(),
-    //                                             w->height() * 1.0 / textureBottomLeft->height()));
+    const QRect geometry = w->frameGeometry();
+    const QRectF rect(geometry.x() + data.xTranslation(),
+                      geometry.y() + data.yTranslation(),
+                      geometry.width() * data.xScale(),
+                      geometry.height() * data.yScale());
+    const qreal radius = qMin<qreal>(m_frameRadius * qMin(data.xScale(), data.yScale()),
+                                     qMin(rect.width(), rect.height()) / 2);
 
-    // m_shader->setUniform("bottomright", 13);
-    // m_shader->setUniform("scale3", QVector2D(w->width() * 1.0 / textureBottomRight->width(),
-    //                                             w->height() * 1.0 / textureBottomRight->height()));
+    if (radius < 1.0)
+        return KWin::Effect::drawWindow(w, mask, region, data);
 
-    // KWin::Effect::drawWindow(w, mask, region, data);
-    // KWin::ShaderManager::instance()->popShader();
+    drawCutWindow(w, mask, region, data, rect, radius,
+                  KWin::effects->renderTargetRect(), KWin::effects->renderTargetScale(),
+                  data.screenProjectionMatrix(), aliased);
+}
 
-    // data.shader = oldShader;
+bool RoundedWindow::drawWindowCached(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data)
+{
+    Q_UNUSED(mask)
+    Q_UNUSED(region)
 
-    glActiveTexture(GL_TEXTURE10);
-    textureTopLeft->unbind();
-    glActiveTexture(GL_TEXTURE0);
+    // Rotations and 3D transforms don't map onto a single quad.
+    if (data.rotationAngle() != 0.0 || data.zScale() != 1.0)
+        return false;
+
+    // Only windows that stopped changing are worth a copy of their own.
+    // Button hover feedback is drawn by the decoration without damaging
+    // the window, so one under the pointer counts as changing.
+    auto damaged = m_damagedFrames.find(w);
+    if (damaged == m_damagedFrames.end())
+        damaged = m_damagedFrames.insert(w, m_frame);
+
+    if (m_frame - *damaged < s_staticFrames) {
+        releaseCachedWindow(w);
+        return false;
+    }
 
-    glActiveTexture(GL_TEXTURE11);
-    textureTopRight->unbind();
-    glActiveTexture(GL_TEXTURE0);
+    if (w->frameGeometry().contains(KWin::effects->cursorPos())) {
+        auto it = m_cachedWindows.find(w);
+        if (it != m_cachedWindows.end())
+            it->second.dirty = true;
+        return false;
+    }
+
+    CachedWindow &cached = m_cachedWindows[w];
+    cached.lastUsed = m_frame;
+
+    if (!updateCachedWindow(w, cached, data)) {
+        releaseCachedWindow(w);
+        return false;
+    }
+
+    const QRect expanded = w->expandedGeometry();
+    const QRectF target(expanded.x() + data.xTranslation(),
+                        expanded.y() + data.yTranslation(),
+                        expanded.width() * data.xScale(),
+                        expanded.height() * data.yScale());
+
+    const qreal opacity = data.opacity();
+    const qreal brightness = data.brightness();
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
-    glActiveTexture(GL_TEXTURE12);
-    textureBottomLeft->unbind();
-    glActiveTexture(GL_TEXTURE0);
+    KWin::ShaderBinder binder(KWin::ShaderTrait::MapTexture | KWin::ShaderTrait::Modulate);
+    binder.shader()->setUniform(KWin::GLShader::ModelViewProjectionMatrix, data.screenProjectionMatrix());
+    binder.shader()->setUniform(KWin::GLShader::TextureMatrix, cached.texture->matrix(KWin::NormalizedCoordinates));
+    binder.shader()->setUniform(KWin::GLShader::ModulationConstant,
+                                QVector4D(opacity * brightness, opacity * brightness, opacity * brightness, opacity));
 
-    glActiveTexture(GL_TEXTURE13);
-    textureBottomRight->unbind();
-    glActiveTexture(GL_TEXTURE0);
+    cached.texture->bind();
+    renderQuad(target, QRectF(0, 0, 1, 1));
+    cached.texture->unbind();
 
     glDisable(GL_BLEND);
+
+    return true;
+}
+
+// Windows drawn smaller than their size, e.g. in present windows, are
+// rendered offscreen at about their on-screen size, in steps of 1/8 so
+// that a zoom animation only reallocates a few times.
+static qreal offscreenScale(const KWin::WindowPaintData &data)
+{
+    const qreal scale = qMax(data.xScale(), data.yScale());
+    return qBound(0.125, std::ceil(scale * 8.0) / 8.0, 1.0);
+}
+
+bool RoundedWindow::updateCachedWindow(KWin::EffectWindow *w, CachedWindow &cached, const KWin::WindowPaintData &data)
+{
+    const QRect expanded = w->expandedGeometry();
+    const qreal scale = KWin::effects->renderTargetScale();
+    const QSize size = (QSizeF(expanded.size()) * scale * offscreenScale(data)).toSize();
+
+    if (size.isEmpty())
+        return false;
+
+    if (data.saturation() != cached.saturation)
+        cached.dirty = true;
+
+    if (!cached.texture || cached.texture->size() != size || cached.scale != scale) {
+        const qint64 bytes = qint64(size.width()) * size.height() * 4;
+
+        m_cacheBytes -= cached.bytes;
+        cached.framebuffer.reset();
+        cached.texture.reset();
+        cached.bytes = 0;
+
+        if (!evictCachedWindows(bytes))
+            return false;
+
+        cached.texture.reset(new KWin::GLTexture(GL_RGBA8, size));
+        cached.texture->setFilter(GL_LINEAR);
+        cached.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        cached.framebuffer.reset(new KWin::GLFramebuffer(cached.texture.get()));
+        cached.scale = scale;
+        cached.bytes = bytes;
+        cached.dirty = true;
+
+        m_cacheBytes += bytes;
+        updateCacheStats();
+    }
+
+    if (!cached.framebuffer->valid())
+        return false;
+
+    if (!cached.dirty) {
+        m_cacheStats.hit();
+        return true;
+    }
+
+    m_cacheStats.miss();
+
+    KWin::GLFramebuffer::pushFramebuffer(cached.framebuffer.get());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Maps the whole window onto the texture, whatever size it has.
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.ortho(QRect(0, 0, expanded.width(), expanded.height()));
+
+    // Continue down the effect chain, but untransformed and into the
+    // offscreen texture.
+    KWin::WindowPaintData windowData(w);
+    windowData.setXTranslation(-expanded.x());
+    windowData.setYTranslation(-expanded.y());
+    windowData.setOpacity(1.0);
+    windowData.setSaturation(data.saturation());
+    windowData.setProjectionMatrix(projectionMatrix);
+
+#if KWIN_EFFECT_API_VERSION < 233
+    windowData.quads = data.quads;
+#endif
+
+    // Cut the corners while rendering, as on screen.
+    const QRectF frame = QRectF(w->frameGeometry()).translated(-expanded.topLeft());
+    const qreal radius = qMin<qreal>(m_frameRadius, qMin(frame.width(), frame.height()) / 2);
+    const int mask = PAINT_WINDOW_TRANSFORMED | PAINT_WINDOW_TRANSLUCENT;
+
+    if (radius < 1.0) {
+        KWin::Effect::drawWindow(w, mask, KWin::infiniteRegion(), windowData);
+    } else {
+        drawCutWindow(w, mask, KWin::infiniteRegion(), windowData, frame, radius,
+                      QRectF(QPointF(0, 0), expanded.size()), qreal(size.width()) / expanded.width(),
+                      projectionMatrix);
+    }
+
+    KWin::GLFramebuffer::popFramebuffer();
+
+    cached.saturation = data.saturation();
+    cached.dirty = false;
+
+    return true;
+}
+
+bool RoundedWindow::evictCachedWindows(qint64 required)
+{
+    // Least recently drawn first. Windows drawn in this frame keep their
+    // texture, when they alone exceed the budget the new one is drawn
+    // directly instead.
+    while (m_cacheBytes + required > m_cacheBudget) {
+        auto victim = m_cachedWindows.end();
+
+        for (auto it = m_cachedWindows.begin(); it != m_cachedWindows.end(); ++it) {
+            if (!it->second.texture || it->second.lastUsed == m_frame)
+                continue;
+            if (victim == m_cachedWindows.end() || it->second.lastUsed < victim->second.lastUsed)
+                victim = it;
+        }
+
+        if (victim == m_cachedWindows.end()) {
+            updateCacheStats();
+            return false;
+        }
+
+        m_cacheBytes -= victim->second.bytes;
+        m_cachedWindows.erase(victim);
+        m_cacheStats.evicted();
+    }
+
+    updateCacheStats();
+    return true;
+}
+
+void RoundedWindow::releaseCachedWindow(const KWin::EffectWindow *w)
+{
+    auto it = m_cachedWindows.find(w);
+    if (it == m_cachedWindows.end())
+        return;
+
+    m_cacheBytes -= it->second.bytes;
+    m_cachedWindows.erase(it);
+    updateCacheStats();
+}
+
+void RoundedWindow::updateCacheStats()
+{
+    m_cacheStats.setUsage(m_cachedWindows.size(), 0, m_cacheBytes);
+}
+
+void RoundedWindow::updateMaskStats()
+{
+    qint64 entries = 0;
+    qint64 cpuBytes = 0;
+    qint64 gpuBytes = 0;
+
+    if (m_cornerAtlas) {
+        ++entries;
+        gpuBytes += qint64(m_cornerAtlas->width()) * m_cornerAtlas->height() * 4;
+    }
+
+    if (m_cornerBuffer) {
+        ++entries;
+        gpuBytes += m_cornerBuffer->vertexCount() * 2 * sizeof(float);
+    }
+
+    if (m_cornerMask) {
+        ++entries;
+        cpuBytes += m_cornerMask->bytes();
+    }
+
+    m_maskStats.setUsage(entries, cpuBytes, gpuBytes);
 }
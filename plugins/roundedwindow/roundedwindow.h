@@ -27,6 +27,17 @@
 
 #include <xcb/xcb_atom.h>
 
+#include <QHash>
+#include <QRegion>
+
+#include <memory>
+#include <unordered_map>
+
+#include "cachestats.h"
+#include "cornermask.h"
+#include "trace.h"
+#include "windowclasslist.h"
+
 class RoundedWindow : public KWin::Effect
 {
     Q_OBJECT
@@ -40,26 +51,153 @@ public:
         WindowDepthRole = BaseRole + 4
     };
 
+    // Verdicts that only depend on the window class and type, computed
+    // once per window instead of on every frame.
+    enum WindowFlag {
+        RoundCorners = 1 << 0,
+        AllowListed = 1 << 1,
+        // Draws its own rounded frame and shadow (GTK/libadwaita CSD).
+        ClientDecorated = 1 << 2
+    };
+
+    // Steps taken while frames overrun the budget, cheapest last.
+    enum QualityTier {
+        FullQuality = 0,
+        AliasedInactive = 1, // inactive windows get corners without antialiasing
+        ActiveOnly = 2,      // only the active window is rounded
+        Bypass = 3
+    };
+    Q_ENUM(QualityTier)
+
     RoundedWindow(QObject *parent = nullptr, const QVariantList &args = QVariantList());
     ~RoundedWindow();
 
     static bool supported();
     static bool enabledByDefault();
 
-    bool hasShadow(KWin::WindowQuadList &qds);
+    void reconfigure(ReconfigureFlags flags) override;
+
+    bool hasShadow(KWin::EffectWindow *w, const KWin::WindowPaintData &data) const;
     bool isMaximized(KWin::EffectWindow *w);
 
+    void prePaintScreen(KWin::ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
     void drawWindow(KWin::EffectWindow* w, int mask, const QRegion &region, KWin::WindowPaintData& data) override;
 
+    // "tier" for the current quality tier and the average frame interval,
+    // see org.kde.kwin.Effects.debug.
+    QString debug(const QString &parameter) const override;
+
+private slots:
+    void slotWindowAdded(KWin::EffectWindow *w);
+    void slotWindowDeleted(KWin::EffectWindow *w);
+    void slotPropertyNotify(KWin::EffectWindow *w, long atom);
+    void slotWindowGeometryChanged(KWin::EffectWindow *w);
+    void slotWindowDamaged(KWin::EffectWindow *w);
+    void slotWindowActivated(KWin::EffectWindow *w);
+
 private:
-    KWin::GLShader *m_shader;
-    KWin::GLTexture *m_texure;
+    // The window rendered once, untransformed and with its corners cut,
+    // into an offscreen texture.
+    struct CachedWindow {
+        std::unique_ptr<KWin::GLTexture> texture;
+        std::unique_ptr<KWin::GLFramebuffer> framebuffer;
+        qreal scale = 1.0;
+        qreal saturation = 1.0;
+        qint64 bytes = 0;
+        quint64 lastUsed = 0;
+        bool dirty = true;
+    };
+
+    int classify(KWin::EffectWindow *w) const;
+    bool isClientDecorated(KWin::EffectWindow *w) const;
+    int windowFlags(KWin::EffectWindow *w);
+
+    bool hasStencil();
+    void drawWindowStencilled(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data);
+    KWin::GLVertexBuffer *cornerBuffer();
+
+    void drawWindowPainted(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data);
+    void drawWindowClipped(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data);
+
+    KWin::GLShader *cornerShader();
+    void drawCutWindow(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data,
+                       const QRectF &rect, qreal radius, const QRectF &viewport, qreal scale,
+                       const QMatrix4x4 &projection, bool aliased = false);
+    void drawWindowBlended(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data,
+                           bool aliased = false);
+
+    bool drawWindowCached(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data);
+    bool updateCachedWindow(KWin::EffectWindow *w, CachedWindow &cached, const KWin::WindowPaintData &data);
+    bool evictCachedWindows(qint64 required);
+    void releaseCachedWindow(const KWin::EffectWindow *w);
+    void updateCacheStats();
+    void updateMaskStats();
+    void updateQualityTier(qreal intervals);
+
+    QRegion clipRegion(const QSize &size);
+    void updateClipRegion(KWin::EffectWindow *w);
 
     xcb_atom_t m_netWMStateAtom = 0;
     xcb_atom_t m_netWMStateMaxHorzAtom = 0;
     xcb_atom_t m_netWMStateMaxVertAtom = 0;
 
+    long m_wmClassAtom = 0;
+    long m_windowTypeAtom = 0;
+    long m_gtkFrameExtentsAtom = 0;
+
     int m_frameRadius;
+    qreal m_devicePixelRatio;
+
+    // The window is drawn once and only its corner squares are blended
+    // back over what was behind, see drawCutWindow(). The atlas holds the
+    // squares before and after the window was drawn.
+    std::unique_ptr<KWin::GLShader> m_cornerShader;
+    std::unique_ptr<KWin::GLTexture> m_cornerAtlas;
+
+    // On software rasterizers (llvmpipe) even the corner pass shows up in
+    // a frame, the corners are cut out with the stencil buffer instead.
+    bool m_softwareRendering = false;
+    // Of the framebuffer bound when it was last asked, per frame.
+    GLint m_stencilFramebuffer = -1;
+    bool m_hasStencil = false;
+    std::unique_ptr<KWin::GLVertexBuffer> m_cornerBuffer;
+
+    // Without OpenGL the corners are blended on the CPU, see cornermask.h.
+    bool m_painterCompositing = false;
+    std::unique_ptr<CornerMask> m_cornerMask;
+
+    // With AdaptiveQuality the tier follows the average time between two
+    // presented frames in refresh intervals of their output, a step down
+    // after 30 frames above 1.2 and a step back up only after 120 frames
+    // below 1.05.
+    bool m_adaptiveQuality = true;
+    QualityTier m_qualityTier = FullQuality;
+    QHash<const KWin::EffectScreen *, std::chrono::milliseconds> m_presentTimes;
+    qreal m_averageInterval = 1.0;
+    int m_framesInTier = 0;
+
+    // With CacheStaticWindows a window left undamaged for s_staticFrames
+    // frames is drawn from an offscreen copy until it changes again.
+    static const quint64 s_staticFrames = 30;
+    bool m_cacheStaticWindows = false;
+    qint64 m_cacheBudget = 0;
+    qint64 m_cacheBytes = 0;
+    quint64 m_frame = 0;
+    QHash<const KWin::EffectWindow *, quint64> m_damagedFrames;
+    std::unordered_map<const KWin::EffectWindow *, CachedWindow> m_cachedWindows;
+
+    Cutefish::Trace::Dumper m_traceDumper{"roundedwindow"};
+    Cutefish::CacheStats::Exporter m_statsExporter{"roundedwindow"};
+    Cutefish::CacheStats m_cacheStats{QStringLiteral("roundedwindow/offscreen windows")};
+    Cutefish::CacheStats m_maskStats{QStringLiteral("roundedwindow/corner masks")};
+    Cutefish::CacheStats m_clipRegionStats{QStringLiteral("roundedwindow/clip regions")};
+
+    Cutefish::WindowClassList m_allowList;
+    QHash<const KWin::EffectWindow *, int> m_windowFlags;
+
+    // Rounded shapes keyed by (size, radius, scale), most windows share
+    // a handful of sizes.
+    QHash<quint64, QRegion> m_clipRegions;
 };
 
 #endif
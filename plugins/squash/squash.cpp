@@ -0,0 +1,509 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "squash.h"
+
+// KDE
+#include <KConfigGroup>
+
+// Qt
+#include <QMatrix4x4>
+#include <QVector2D>
+#include <QTextStream>
+
+#include <QVector>
+
+// Cells of the deformation grid are roughly this many pixels wide.
+static const int s_cellSize = 24;
+static const int s_minCells = 4;
+static const int s_maxCells = 64;
+static const int s_maxCachedGrids = 16;
+
+// Windows in a burst shrink down to this fraction of their size.
+static const qreal s_burstMinScale = 0.8;
+
+static std::unique_ptr<KWin::GLShader> getShader()
+{
+    QByteArray vertexSource;
+    QByteArray fragmentSource;
+    QTextStream vertex(&vertexSource);
+    QTextStream fragment(&fragmentSource);
+
+    KWin::GLPlatform * const gl = KWin::GLPlatform::instance();
+    QByteArray attribute, varyingIn, varyingOut, output, textureLookup;
+
+    if (!gl->isGLES()) {
+        const bool glsl_140 = gl->glslVersion() >= KWin::kVersionNumber(1, 40);
+
+        if (glsl_140) {
+            vertex << "#version 140\n\n";
+            fragment << "#version 140\n\n";
+        }
+
+        attribute     = glsl_140 ? QByteArrayLiteral("in")         : QByteArrayLiteral("attribute");
+        varyingOut    = glsl_140 ? QByteArrayLiteral("out")        : QByteArrayLiteral("varying");
+        varyingIn     = glsl_140 ? QByteArrayLiteral("in")         : QByteArrayLiteral("varying");
+        textureLookup = glsl_140 ? QByteArrayLiteral("texture")    : QByteArrayLiteral("texture2D");
+        output        = glsl_140 ? QByteArrayLiteral("fragColor")  : QByteArrayLiteral("gl_FragColor");
+    } else {
+        const bool glsl_es_300 = gl->glslVersion() >= KWin::kVersionNumber(3, 0);
+
+        if (glsl_es_300) {
+            vertex << "#version 300 es\n\n";
+            fragment << "#version 300 es\n\n";
+        }
+
+        vertex << "precision highp float;\n\n";
+        fragment << "precision highp float;\n\n";
+
+        attribute     = glsl_es_300 ? QByteArrayLiteral("in")         : QByteArrayLiteral("attribute");
+        varyingOut    = glsl_es_300 ? QByteArrayLiteral("out")        : QByteArrayLiteral("varying");
+        varyingIn     = glsl_es_300 ? QByteArrayLiteral("in")         : QByteArrayLiteral("varying");
+        textureLookup = glsl_es_300 ? QByteArrayLiteral("texture")    : QByteArrayLiteral("texture2D");
+        output        = glsl_es_300 ? QByteArrayLiteral("fragColor")  : QByteArrayLiteral("gl_FragColor");
+    }
+
+    // The grid is uploaded once in normalized window coordinates, all the
+    // bending happens here. Geometry is expressed along the axis pointing
+    // to the icon ("along") and the axis perpendicular to it ("cross"),
+    // so the same code handles docks on every screen edge.
+    vertex << "uniform mat4 modelViewProjectionMatrix;\n";
+    vertex << "uniform mat4 textureMatrix;\n";
+    vertex << "uniform float progress;\n";
+    vertex << "uniform float vertical;\n";
+    vertex << "uniform float direction;\n";
+    vertex << "uniform vec2 windowAlong;\n";
+    vertex << "uniform vec2 windowCross;\n";
+    vertex << "uniform vec2 iconAlong;\n";
+    vertex << "uniform vec2 iconCross;\n\n";
+    vertex << attribute << " vec4 position;\n";
+    vertex << attribute << " vec4 texcoord;\n\n";
+    vertex << varyingOut << " vec2 texcoord0;\n\n";
+
+    vertex << "void main(void)\n{\n";
+    vertex << "    vec2 uv = position.xy;\n"
+              "    float alongUV = mix(uv.x, uv.y, vertical);\n"
+              "    float crossUV = mix(uv.y, uv.x, vertical);\n"
+              "    if (direction < 0.0)\n"
+              "        alongUV = 1.0 - alongUV;\n"
+              "\n"
+              "    float squeeze = clamp(progress / 0.5, 0.0, 1.0);\n"
+              "    float slide = clamp((progress - 0.3) / 0.7, 0.0, 1.0);\n"
+              "\n"
+              "    float windowLength = max(windowAlong.y - windowAlong.x, 1.0);\n"
+              "    float iconLength = iconAlong.y - iconAlong.x;\n"
+              "    float along = mix(windowAlong.x, windowAlong.y, alongUV);\n"
+              "    along = mix(along, iconAlong.x + (along - windowAlong.x) * iconLength / windowLength, slide);\n"
+              "\n"
+              "    float funnel = clamp((along - windowAlong.x) / max(iconAlong.x - windowAlong.x, 1.0), 0.0, 1.0);\n"
+              "    funnel = max(squeeze * smoothstep(0.0, 1.0, funnel), slide);\n"
+              "    float crossStart = mix(windowCross.x, iconCross.x, funnel);\n"
+              "    float crossEnd = mix(windowCross.y, iconCross.y, funnel);\n"
+              "    float cross = mix(crossStart, crossEnd, crossUV);\n"
+              "\n"
+              "    along *= direction;\n"
+              "    vec2 pos = mix(vec2(along, cross), vec2(cross, along), vertical);\n"
+              "\n"
+              "    texcoord0 = (textureMatrix * vec4(uv, 0.0, 1.0)).xy;\n"
+              "    gl_Position = modelViewProjectionMatrix * vec4(pos, 0.0, 1.0);\n";
+    vertex << "}";
+    vertex.flush();
+
+    fragment << "uniform sampler2D sampler;\n";
+    fragment << "uniform vec4 modulation;\n\n";
+    fragment << varyingIn << " vec2 texcoord0;\n";
+
+    if (output != QByteArrayLiteral("gl_FragColor"))
+        fragment << "\nout vec4 " << output << ";\n";
+
+    fragment << "\nvoid main(void)\n{\n";
+    fragment << "    " << output << " = " << textureLookup << "(sampler, texcoord0) * modulation;\n";
+    fragment << "}";
+    fragment.flush();
+
+    KWin::ShaderTraits traits;
+    traits |= KWin::ShaderTrait::MapTexture;
+    traits |= KWin::ShaderTrait::Modulate;
+
+    return KWin::ShaderManager::instance()->generateCustomShader(traits, vertexSource, fragmentSource);
+}
+
+SquashEffect::SquashEffect(QObject *, const QVariantList &)
+    : KWin::Effect()
+    , m_shader(getShader())
+{
+    m_clock.start();
+    reconfigure(ReconfigureAll);
+
+    connect(KWin::effects, &KWin::EffectsHandler::windowMinimized, this, &SquashEffect::slotWindowMinimized);
+    connect(KWin::effects, &KWin::EffectsHandler::windowUnminimized, this, &SquashEffect::slotWindowUnminimized);
+    connect(KWin::effects, &KWin::EffectsHandler::windowDamaged, this, &SquashEffect::slotWindowDamaged);
+    connect(KWin::effects, &KWin::EffectsHandler::windowDeleted, this, &SquashEffect::slotWindowDeleted);
+}
+
+SquashEffect::~SquashEffect()
+{
+    qDeleteAll(m_grids);
+}
+
+bool SquashEffect::supported()
+{
+    return KWin::effects->isOpenGLCompositing() && KWin::GLFramebuffer::supported();
+}
+
+bool SquashEffect::enabledByDefault()
+{
+    return supported();
+}
+
+void SquashEffect::reconfigure(ReconfigureFlags flags)
+{
+    Q_UNUSED(flags)
+
+    KConfigGroup conf = KWin::effects->effectConfig(QStringLiteral("cutefishsquash"));
+
+    m_duration = std::chrono::milliseconds(animationTime(300));
+    m_burstThreshold = conf.readEntry("BurstThreshold", 3);
+    m_burstInterval = conf.readEntry("BurstInterval", 150);
+
+    m_burstTimeLine.setDuration(m_duration / 2);
+    m_burstTimeLine.setEasingCurve(QEasingCurve::OutQuad);
+}
+
+void SquashEffect::prePaintScreen(KWin::ScreenPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    for (auto it = m_animations.begin(); it != m_animations.end(); ++it)
+        it->second.timeLine.advance(presentTime);
+
+    if (!m_burstWindows.isEmpty())
+        m_burstTimeLine.advance(presentTime);
+
+    data.mask |= PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS;
+
+    KWin::effects->prePaintScreen(data, presentTime);
+}
+
+void SquashEffect::prePaintWindow(KWin::EffectWindow *w, KWin::WindowPrePaintData &data, std::chrono::milliseconds presentTime)
+{
+    if (m_animations.find(w) != m_animations.end() || m_burstWindows.contains(w)) {
+        data.setTransformed();
+        w->enablePainting(KWin::EffectWindow::PAINT_DISABLED_BY_MINIMIZE);
+    }
+
+    KWin::effects->prePaintWindow(w, data, presentTime);
+}
+
+void SquashEffect::drawWindow(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data)
+{
+    auto burstIt = m_burstWindows.constFind(w);
+    if (burstIt != m_burstWindows.constEnd())
+        return drawBurstWindow(w, *burstIt, mask, region, data);
+
+    auto it = m_animations.find(w);
+    if (it == m_animations.end())
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    Animation &animation = it->second;
+    if (animation.dirty)
+        updateTexture(w, animation);
+
+    if (!animation.texture)
+        return KWin::Effect::drawWindow(w, mask, region, data);
+
+    const QRect windowRect = w->frameGeometry();
+    const QRect iconRect = w->iconGeometry();
+
+    // Pick the screen edge the icon sits on, the deformation always bends
+    // the window towards it.
+    const QPoint delta = iconRect.center() - windowRect.center();
+    const bool vertical = qAbs(delta.y()) >= qAbs(delta.x());
+    const float direction = (vertical ? delta.y() : delta.x()) >= 0 ? 1.0f : -1.0f;
+
+    auto along = [&](const QRect &rect) {
+        const float start = vertical ? rect.top() : rect.left();
+        const float end = vertical ? rect.y() + rect.height() : rect.x() + rect.width();
+        return direction > 0 ? QVector2D(start, end) : QVector2D(-end, -start);
+    };
+    auto cross = [&](const QRect &rect) {
+        return vertical ? QVector2D(rect.left(), rect.x() + rect.width())
+                        : QVector2D(rect.top(), rect.y() + rect.height());
+    };
+
+    const qreal opacity = data.opacity();
+
+    KWin::ShaderManager::instance()->pushShader(m_shader.get());
+    m_shader->setUniform(KWin::GLShader::ModelViewProjectionMatrix, data.screenProjectionMatrix());
+    m_shader->setUniform(KWin::GLShader::TextureMatrix, animation.texture->matrix(KWin::NormalizedCoordinates));
+    m_shader->setUniform(KWin::GLShader::ModulationConstant, QVector4D(opacity, opacity, opacity, opacity));
+    m_shader->setUniform("progress", float(animation.timeLine.value()));
+    m_shader->setUniform("vertical", vertical ? 1.0f : 0.0f);
+    m_shader->setUniform("direction", direction);
+    m_shader->setUniform("windowAlong", along(windowRect));
+    m_shader->setUniform("windowCross", cross(windowRect));
+    m_shader->setUniform("iconAlong", along(iconRect));
+    m_shader->setUniform("iconCross", cross(iconRect));
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    animation.texture->bind();
+    gridFor(windowRect.size())->render(GL_TRIANGLES);
+    animation.texture->unbind();
+
+    glDisable(GL_BLEND);
+
+    KWin::ShaderManager::instance()->popShader();
+}
+
+void SquashEffect::drawBurstWindow(KWin::EffectWindow *w, const BurstWindow &burstWindow, int mask, const QRegion &region, KWin::WindowPaintData &data)
+{
+    const qreal visible = burstVisible(burstWindow);
+
+    if (visible <= 0.0)
+        return;
+
+    const qreal scale = s_burstMinScale + (1.0 - s_burstMinScale) * visible;
+    const QRect geometry = w->frameGeometry();
+
+    data.multiplyOpacity(visible);
+    data *= QVector2D(scale, scale);
+    data += QPointF(geometry.width() * (1.0 - scale) / 2.0, geometry.height() * (1.0 - scale) / 2.0);
+
+    KWin::Effect::drawWindow(w, mask, region, data);
+}
+
+void SquashEffect::postPaintScreen()
+{
+    for (auto it = m_animations.begin(); it != m_animations.end();) {
+        if (it->second.timeLine.done())
+            it = m_animations.erase(it);
+        else
+            ++it;
+    }
+
+    if (!m_burstWindows.isEmpty() && m_burstTimeLine.done())
+        m_burstWindows.clear();
+
+    KWin::effects->addRepaintFull();
+    KWin::effects->postPaintScreen();
+}
+
+bool SquashEffect::isActive() const
+{
+    return !m_animations.empty() || !m_burstWindows.isEmpty();
+}
+
+void SquashEffect::slotWindowMinimized(KWin::EffectWindow *w)
+{
+    startAnimation(w, KWin::TimeLine::Forward);
+}
+
+void SquashEffect::slotWindowUnminimized(KWin::EffectWindow *w)
+{
+    startAnimation(w, KWin::TimeLine::Backward);
+}
+
+void SquashEffect::slotWindowDamaged(KWin::EffectWindow *w)
+{
+    auto it = m_animations.find(w);
+    if (it != m_animations.end())
+        it->second.dirty = true;
+}
+
+void SquashEffect::slotWindowDeleted(KWin::EffectWindow *w)
+{
+    m_animations.erase(w);
+    m_burstWindows.remove(w);
+}
+
+void SquashEffect::startAnimation(KWin::EffectWindow *w, KWin::TimeLine::Direction direction)
+{
+    if (KWin::effects->hasActiveFullScreenEffect())
+        return;
+
+    // If the window doesn't have an icon in the task manager,
+    // don't animate it.
+    const QRect iconRect = w->iconGeometry();
+    if (!iconRect.isValid())
+        return;
+
+    if (registerEvent())
+        return joinBurst(w, direction == KWin::TimeLine::Forward);
+
+    auto it = m_animations.find(w);
+    if (it != m_animations.end()) {
+        // Reverse the running animation instead of jumping.
+        it->second.timeLine.setDirection(direction);
+        return;
+    }
+
+    Animation &animation = m_animations[w];
+    animation.visibleRef = KWin::EffectWindowVisibleRef(w, KWin::EffectWindow::PAINT_DISABLED_BY_MINIMIZE);
+    animation.timeLine.setDirection(direction);
+    animation.timeLine.setDuration(m_duration);
+    animation.timeLine.setEasingCurve(QEasingCurve::OutSine);
+
+    KWin::effects->addRepaintFull();
+}
+
+bool SquashEffect::registerEvent()
+{
+    const qint64 now = m_clock.elapsed();
+
+    m_recentEvents.append(now);
+    while (!m_recentEvents.isEmpty() && now - m_recentEvents.first() > m_burstInterval)
+        m_recentEvents.removeFirst();
+
+    if (!m_burstWindows.isEmpty())
+        return true;
+
+    if (m_recentEvents.size() <= m_burstThreshold)
+        return false;
+
+    // The burst starts now, move the windows that already started their
+    // own animation over to the shared timeline, from where they are.
+    m_burstTimeLine.reset();
+    for (auto it = m_animations.begin(); it != m_animations.end(); ++it) {
+        BurstWindow &burstWindow = m_burstWindows[it->first];
+        burstWindow.visibleRef = it->second.visibleRef;
+        burstWindow.minimizing = it->second.timeLine.direction() == KWin::TimeLine::Forward;
+        burstWindow.startVisible = 1.0 - it->second.timeLine.value();
+        burstWindow.startProgress = 0.0;
+    }
+    m_animations.clear();
+
+    return true;
+}
+
+void SquashEffect::joinBurst(KWin::EffectWindow *w, bool minimizing)
+{
+    // Whatever animates the window now, it goes on from what is on
+    // screen instead of jumping to the start.
+    qreal visible = minimizing ? 1.0 : 0.0;
+
+    auto it = m_animations.find(w);
+    if (it != m_animations.end()) {
+        visible = 1.0 - it->second.timeLine.value();
+        m_animations.erase(it);
+    }
+
+    auto burstIt = m_burstWindows.constFind(w);
+    if (burstIt != m_burstWindows.constEnd())
+        visible = burstVisible(*burstIt);
+
+    BurstWindow &burstWindow = m_burstWindows[w];
+    burstWindow.visibleRef = KWin::EffectWindowVisibleRef(w, KWin::EffectWindow::PAINT_DISABLED_BY_MINIMIZE);
+    burstWindow.minimizing = minimizing;
+    burstWindow.startVisible = visible;
+    burstWindow.startProgress = m_burstTimeLine.value();
+
+    KWin::effects->addRepaintFull();
+}
+
+qreal SquashEffect::burstVisible(const BurstWindow &burstWindow) const
+{
+    // The rest of the shared timeline, whatever is left of it when the
+    // window joined.
+    const qreal remaining = 1.0 - burstWindow.startProgress;
+    const qreal progress = remaining > 0.0
+            ? qBound(0.0, (m_burstTimeLine.value() - burstWindow.startProgress) / remaining, 1.0)
+            : 1.0;
+
+    const qreal end = burstWindow.minimizing ? 0.0 : 1.0;
+    return burstWindow.startVisible + (end - burstWindow.startVisible) * progress;
+}
+
+void SquashEffect::updateTexture(KWin::EffectWindow *w, Animation &animation)
+{
+    const QRect geometry = w->frameGeometry();
+
+    if (!animation.texture || animation.texture->size() != geometry.size()) {
+        animation.framebuffer.reset();
+        animation.texture.reset(new KWin::GLTexture(GL_RGBA8, geometry.size()));
+        animation.texture->setFilter(GL_LINEAR);
+        animation.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+        animation.framebuffer.reset(new KWin::GLFramebuffer(animation.texture.get()));
+    }
+
+    if (!animation.framebuffer->valid()) {
+        animation.framebuffer.reset();
+        animation.texture.reset();
+        return;
+    }
+
+    KWin::GLFramebuffer::pushFramebuffer(animation.framebuffer.get());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    QMatrix4x4 projectionMatrix;
+    projectionMatrix.ortho(QRect(0, 0, geometry.width(), geometry.height()));
+
+    KWin::WindowPaintData data(w);
+    data.setXTranslation(-geometry.x());
+    data.setYTranslation(-geometry.y());
+    data.setOpacity(1.0);
+    data.setProjectionMatrix(projectionMatrix);
+
+    const int mask = PAINT_WINDOW_TRANSFORMED | PAINT_WINDOW_TRANSLUCENT;
+    KWin::effects->drawWindow(w, mask, KWin::infiniteRegion(), data);
+
+    KWin::GLFramebuffer::popFramebuffer();
+
+    animation.dirty = false;
+}
+
+KWin::GLVertexBuffer *SquashEffect::gridFor(const QSize &size)
+{
+    const int columns = qBound(s_minCells, size.width() / s_cellSize, s_maxCells);
+    const int rows = qBound(s_minCells, size.height() / s_cellSize, s_maxCells);
+    const quint64 key = (quint64(columns) << 32) | quint64(rows);
+
+    KWin::GLVertexBuffer *grid = m_grids.value(key);
+    if (grid)
+        return grid;
+
+    if (m_grids.size() >= s_maxCachedGrids) {
+        qDeleteAll(m_grids);
+        m_grids.clear();
+    }
+
+    // Two triangles per cell, positions double as texture coordinates.
+    QVector<float> vertices;
+    vertices.reserve(columns * rows * 12);
+
+    for (int row = 0; row < rows; ++row) {
+        const float y0 = float(row) / rows;
+        const float y1 = float(row + 1) / rows;
+
+        for (int column = 0; column < columns; ++column) {
+            const float x0 = float(column) / columns;
+            const float x1 = float(column + 1) / columns;
+
+            vertices << x0 << y0 << x1 << y0 << x1 << y1
+                     << x1 << y1 << x0 << y1 << x0 << y0;
+        }
+    }
+
+    grid = new KWin::GLVertexBuffer(KWin::GLVertexBuffer::Static);
+    grid->setData(vertices.size() / 2, 2, vertices.constData(), vertices.constData());
+    m_grids.insert(key, grid);
+
+    return grid;
+}
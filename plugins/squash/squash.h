@@ -0,0 +1,106 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SQUASH_H
+#define SQUASH_H
+
+#include <kwineffects.h>
+#include <kwinglplatform.h>
+#include <kwinglutils.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+#include <memory>
+#include <unordered_map>
+
+class SquashEffect : public KWin::Effect
+{
+    Q_OBJECT
+
+public:
+    SquashEffect(QObject *parent = nullptr, const QVariantList &args = QVariantList());
+    ~SquashEffect() override;
+
+    static bool supported();
+    static bool enabledByDefault();
+
+    void reconfigure(ReconfigureFlags flags) override;
+
+    void prePaintScreen(KWin::ScreenPrePaintData &data, std::chrono::milliseconds presentTime) override;
+    void prePaintWindow(KWin::EffectWindow *w, KWin::WindowPrePaintData &data, std::chrono::milliseconds presentTime) override;
+    void drawWindow(KWin::EffectWindow *w, int mask, const QRegion &region, KWin::WindowPaintData &data) override;
+    void postPaintScreen() override;
+
+    bool isActive() const override;
+    int requestedEffectChainPosition() const override { return 50; }
+
+private slots:
+    void slotWindowMinimized(KWin::EffectWindow *w);
+    void slotWindowUnminimized(KWin::EffectWindow *w);
+    void slotWindowDamaged(KWin::EffectWindow *w);
+    void slotWindowDeleted(KWin::EffectWindow *w);
+
+private:
+    // The window contents are captured once into an offscreen texture and
+    // then drawn through a static grid, the vertex shader does the bending.
+    struct Animation {
+        KWin::EffectWindowVisibleRef visibleRef;
+        KWin::TimeLine timeLine;
+        std::unique_ptr<KWin::GLTexture> texture;
+        std::unique_ptr<KWin::GLFramebuffer> framebuffer;
+        bool dirty = true;
+    };
+
+    // When many windows (un)minimize at once, e.g. "show desktop", they
+    // share one timeline and only fade and shrink, no textures are kept.
+    // A window that joins late goes on from how visible it was then and
+    // reaches its end together with the others.
+    struct BurstWindow {
+        KWin::EffectWindowVisibleRef visibleRef;
+        bool minimizing = true;
+        qreal startVisible = 1.0;
+        qreal startProgress = 0.0;
+    };
+
+    void startAnimation(KWin::EffectWindow *w, KWin::TimeLine::Direction direction);
+    bool registerEvent();
+    void joinBurst(KWin::EffectWindow *w, bool minimizing);
+    qreal burstVisible(const BurstWindow &burstWindow) const;
+    void drawBurstWindow(KWin::EffectWindow *w, const BurstWindow &burstWindow, int mask, const QRegion &region, KWin::WindowPaintData &data);
+    void updateTexture(KWin::EffectWindow *w, Animation &animation);
+    KWin::GLVertexBuffer *gridFor(const QSize &size);
+
+    std::unique_ptr<KWin::GLShader> m_shader;
+
+    std::unordered_map<KWin::EffectWindow *, Animation> m_animations;
+    QHash<quint64, KWin::GLVertexBuffer *> m_grids;
+
+    QHash<KWin::EffectWindow *, BurstWindow> m_burstWindows;
+    KWin::TimeLine m_burstTimeLine;
+    QElapsedTimer m_clock;
+    QList<qint64> m_recentEvents;
+
+    std::chrono::milliseconds m_duration;
+    int m_burstThreshold;
+    qint64 m_burstInterval;
+};
+
+#endif
@@ -0,0 +1,212 @@
+import QtQuick 6.0
+import QtQuick.Window 6.0
+import QtQuick.Controls 6.0
+import QtQuick.Layouts 6.0
+
+import org.kde.kquickcontrolsaddons 2.0
+import org.kde.kwin 3.0 as KWin
+
+import FishUI 1.0 as FishUI
+
+Window {
+    id: dialog
+
+    // The KWin.TabBoxSwitcher this dialog belongs to.
+    property QtObject switcher
+    property alias currentIndex: thumbnailGridView.currentIndex
+
+    visible: switcher.visible
+    flags: Qt.BypassWindowManagerHint | Qt.FramelessWindowHint
+    color: "transparent"
+
+    property int maxWidth: switcher.screenGeometry.width * 0.95
+    property int maxHeight: switcher.screenGeometry.height * 0.7
+    property int optimalWidth: thumbnailGridView.cellWidth * gridColumns
+    property int optimalHeight: thumbnailGridView.cellHeight * gridRows
+    property int gridColumns: gridLayout.columns
+    property int gridRows: gridLayout.rows
+
+    width: Math.min(Math.max(thumbnailGridView.cellWidth, optimalWidth), maxWidth)
+    height: Math.min(Math.max(thumbnailGridView.cellHeight, optimalHeight), maxHeight)
+
+    x: switcher.screenGeometry.x + (switcher.screenGeometry.width - dialog.width) / 2
+    y: switcher.screenGeometry.y + (switcher.screenGeometry.height - dialog.height) / 2
+
+    FishUI.WindowHelper {
+        id: windowHelper
+    }
+
+    FishUI.WindowBlur {
+        view: dialog
+        geometry: Qt.rect(dialog.x, dialog.y, dialog.width, dialog.height)
+        windowRadius: _background.radius
+        enabled: windowHelper.compositing
+    }
+
+    FishUI.WindowShadow {
+        view: dialog
+        geometry: Qt.rect(dialog.x, dialog.y, dialog.width, dialog.height)
+        radius: _background.radius
+    }
+
+    Rectangle {
+        id: _background
+        anchors.fill: parent
+        radius: windowHelper.compositing ? 14 : 0
+        color: FishUI.Theme.backgroundColor
+        opacity: windowHelper.compositing ? FishUI.Theme.darkMode ? 0.3 : 0.4 : 1.0
+
+        border.color: FishUI.Theme.darkMode ? "#686868" : "#D9D9D9"
+        border.width: windowHelper.compositing ? 0 : 1
+    }
+
+    GridLayoutHelper {
+        id: gridLayout
+        count: thumbnailGridView.count
+        cellWidth: thumbnailGridView.cellWidth
+        cellHeight: thumbnailGridView.cellHeight
+        maxWidth: dialog.maxWidth
+        maxHeight: dialog.maxHeight
+    }
+
+    Item {
+        id: dialogMainItem
+        anchors.fill: parent
+
+        property real screenFactor: switcher.screenGeometry.width / switcher.screenGeometry.height
+
+        property bool canStretchX: false
+        property bool canStretchY: false
+
+        clip: true
+
+        property bool mouseEnabled: false
+        MouseArea {
+            id: mouseDetector
+            anchors.fill: parent
+            hoverEnabled: true
+            onPositionChanged: dialogMainItem.mouseEnabled = true
+        }
+
+        GridView {
+            id: thumbnailGridView
+            // KWin resets its model on every open. Through SwitcherModel
+            // that becomes a change of the rows already shown, so the
+            // delegates made on the first open stay for the later ones.
+            model: SwitcherModel {
+                sourceModel: switcher.model
+            }
+            // interactive: false // Disable drag to scroll
+
+            anchors.fill: parent
+
+            property int captionRowHeight: 22
+            property int thumbnailWidth: 300
+            property int thumbnailHeight: thumbnailWidth * (1.0 / dialogMainItem.screenFactor)
+            cellWidth: thumbnailWidth
+            cellHeight: captionRowHeight + thumbnailHeight
+            height: cellHeight
+
+            clip: true
+
+            // Create the rows past the visible area too, so that moving to
+            // them does not create a thumbnail while the switcher is open.
+            cacheBuffer: Math.max(0, gridLayout.rows - 1) * cellHeight
+
+            delegate: Item {
+                property bool isCurrent: thumbnailGridView.currentIndex === index
+
+                width: thumbnailGridView.cellWidth
+                height: thumbnailGridView.cellHeight
+
+                MouseArea {
+                    anchors.fill: parent
+                    // hoverEnabled: dialogMainItem.mouseEnabled
+                    // onEntered: parent.hover()
+                    onClicked: {
+                        parent.select()
+                        // dialog.close() // Doesn't end the effects until you release Alt.
+                    }
+                }
+                function select() {
+                    thumbnailGridView.currentIndex = index;
+                    thumbnailGridView.currentIndexChanged(thumbnailGridView.currentIndex);
+                }
+
+                ColumnLayout {
+                    anchors.fill: parent
+                    anchors.margins: 16
+
+                    Item {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+
+                        // Drawn by the compositor from the texture it already
+                        // has for the window, nothing is read back.
+                        KWin.WindowThumbnail {
+                            id: thumbnailItem
+                            anchors.fill: parent
+                            wId: model.windowId
+                        }
+
+                        QIconItem {
+                            id: iconItem
+                            // source: model.icon
+                            icon: model.icon
+                            width: parent.height * 0.3
+                            height: width
+                            anchors.horizontalCenter: parent.horizontalCenter
+                            anchors.bottom: parent.bottom
+                            state: index == thumbnailGridView.currentIndex ? QIconItem.ActiveState : QIconItem.DefaultState
+                        }
+                    }
+
+                    Label {
+                        text: model.caption
+                        Layout.fillWidth: true
+                        elide: Text.ElideRight
+                        horizontalAlignment: Text.AlignHCenter
+                        color: isCurrent ? FishUI.Theme.highlightedTextColor : FishUI.Theme.textColor
+                    }
+                }
+            } // GridView.delegate
+
+            highlight: Item {
+                id: highlightItem
+
+                Rectangle {
+                    anchors.fill: parent
+                    anchors.margins: FishUI.Units.largeSpacing
+                    radius: _background.radius
+                    color: FishUI.Theme.highlightColor
+                    opacity: 0.7
+                }
+            }
+
+            Connections {
+                target: switcher
+                function onCurrentIndexChanged() {
+                    thumbnailGridView.currentIndex = switcher.currentIndex
+                }
+            }
+        } // GridView
+
+        // This doesn't work, nor does keyboard input work on any other tabbox skin (KDE 5.7.4)
+        // It does work in the preview however.
+        Keys.onPressed: {
+            if (event.key == Qt.Key_Left) {
+                thumbnailGridView.moveCurrentIndexLeft();
+            } else if (event.key == Qt.Key_Right) {
+                thumbnailGridView.moveCurrentIndexRight();
+            } else if (event.key == Qt.Key_Up) {
+                thumbnailGridView.moveCurrentIndexUp();
+            } else if (event.key == Qt.Key_Down) {
+                thumbnailGridView.moveCurrentIndexDown();
+            } else {
+                return;
+            }
+
+            thumbnailGridView.currentIndexChanged(thumbnailGridView.currentIndex);
+        }
+    } // dialogMainItem
+}
@@ -0,0 +1,112 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "gridlayouthelper.h"
+
+static int ceilDiv(int a, int b)
+{
+    return (a + b - 1) / b;
+}
+
+static int optimalColumns(int count, int maxColumns, int maxRows)
+{
+    // Fewest rows that fit the width, the height only limits how far the
+    // view has to scroll. Then spread the cells evenly over those rows.
+    int rows = ceilDiv(count, maxColumns);
+    if (maxRows > 0)
+        rows = qMax(1, qMin(rows, maxRows));
+
+    return qBound(1, ceilDiv(count, rows), maxColumns);
+}
+
+GridLayoutHelper::GridLayoutHelper(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GridLayoutHelper::setCount(int count)
+{
+    if (m_count == count)
+        return;
+
+    m_count = count;
+    emit countChanged();
+    updateLayout();
+}
+
+void GridLayoutHelper::setCellWidth(int width)
+{
+    if (m_cellWidth == width)
+        return;
+
+    m_cellWidth = width;
+    emit cellWidthChanged();
+    updateLayout();
+}
+
+void GridLayoutHelper::setCellHeight(int height)
+{
+    if (m_cellHeight == height)
+        return;
+
+    m_cellHeight = height;
+    emit cellHeightChanged();
+    updateLayout();
+}
+
+void GridLayoutHelper::setMaxWidth(int width)
+{
+    if (m_maxWidth == width)
+        return;
+
+    m_maxWidth = width;
+    emit maxWidthChanged();
+    updateLayout();
+}
+
+void GridLayoutHelper::setMaxHeight(int height)
+{
+    if (m_maxHeight == height)
+        return;
+
+    m_maxHeight = height;
+    emit maxHeightChanged();
+    updateLayout();
+}
+
+void GridLayoutHelper::updateLayout()
+{
+    int columns = 1;
+    int rows = 0;
+
+    if (m_count > 0 && m_cellWidth > 0 && m_cellHeight > 0) {
+        const int maxColumns = qMax(1, qMin(m_count, m_maxWidth / m_cellWidth));
+        const int maxRows = m_maxHeight / m_cellHeight;
+
+        columns = optimalColumns(m_count, maxColumns, maxRows);
+        rows = ceilDiv(m_count, columns);
+    }
+
+    if (m_columns == columns && m_rows == rows)
+        return;
+
+    m_columns = columns;
+    m_rows = rows;
+    emit layoutChanged();
+}
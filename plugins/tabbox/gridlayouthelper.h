@@ -0,0 +1,84 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef GRIDLAYOUTHELPER_H
+#define GRIDLAYOUTHELPER_H
+
+#include <QObject>
+#include <QtQml/qqmlregistration.h>
+
+// Computes the switcher grid: as few rows as fit into maxWidth and
+// maxHeight, then as few columns as those rows need, so the last row
+// is never more than one cell short per row.
+class GridLayoutHelper : public QObject
+{
+    Q_OBJECT
+    QML_ELEMENT
+
+    Q_PROPERTY(int count READ count WRITE setCount NOTIFY countChanged)
+    Q_PROPERTY(int cellWidth READ cellWidth WRITE setCellWidth NOTIFY cellWidthChanged)
+    Q_PROPERTY(int cellHeight READ cellHeight WRITE setCellHeight NOTIFY cellHeightChanged)
+    Q_PROPERTY(int maxWidth READ maxWidth WRITE setMaxWidth NOTIFY maxWidthChanged)
+    Q_PROPERTY(int maxHeight READ maxHeight WRITE setMaxHeight NOTIFY maxHeightChanged)
+    Q_PROPERTY(int columns READ columns NOTIFY layoutChanged)
+    Q_PROPERTY(int rows READ rows NOTIFY layoutChanged)
+
+public:
+    explicit GridLayoutHelper(QObject *parent = nullptr);
+
+    int count() const { return m_count; }
+    void setCount(int count);
+
+    int cellWidth() const { return m_cellWidth; }
+    void setCellWidth(int width);
+
+    int cellHeight() const { return m_cellHeight; }
+    void setCellHeight(int height);
+
+    int maxWidth() const { return m_maxWidth; }
+    void setMaxWidth(int width);
+
+    int maxHeight() const { return m_maxHeight; }
+    void setMaxHeight(int height);
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+
+signals:
+    void countChanged();
+    void cellWidthChanged();
+    void cellHeightChanged();
+    void maxWidthChanged();
+    void maxHeightChanged();
+    void layoutChanged();
+
+private:
+    void updateLayout();
+
+    int m_count = 0;
+    int m_cellWidth = 0;
+    int m_cellHeight = 0;
+    int m_maxWidth = 0;
+    int m_maxHeight = 0;
+
+    int m_columns = 1;
+    int m_rows = 0;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "switchermodel.h"
+
+SwitcherModel::SwitcherModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void SwitcherModel::setSourceModel(QAbstractItemModel *model)
+{
+    if (m_sourceModel == model)
+        return;
+
+    if (m_sourceModel)
+        disconnect(m_sourceModel, nullptr, this, nullptr);
+
+    beginResetModel();
+    m_sourceModel = model;
+    m_count = model ? model->rowCount() : 0;
+    endResetModel();
+
+    if (model) {
+        connect(model, &QAbstractItemModel::modelReset, this, &SwitcherModel::sync);
+        connect(model, &QAbstractItemModel::rowsInserted, this, &SwitcherModel::sync);
+        connect(model, &QAbstractItemModel::rowsRemoved, this, &SwitcherModel::sync);
+        connect(model, &QAbstractItemModel::rowsMoved, this, &SwitcherModel::sync);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &SwitcherModel::sync);
+        connect(model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+            if (topLeft.row() < m_count)
+                emit dataChanged(index(topLeft.row()), index(qMin(bottomRight.row(), m_count - 1)), roles);
+        });
+    }
+
+    emit sourceModelChanged();
+}
+
+int SwitcherModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant SwitcherModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_sourceModel || !index.isValid() || index.row() >= m_sourceModel->rowCount())
+        return QVariant();
+
+    return m_sourceModel->data(m_sourceModel->index(index.row(), 0), role);
+}
+
+QHash<int, QByteArray> SwitcherModel::roleNames() const
+{
+    return m_sourceModel ? m_sourceModel->roleNames() : QAbstractListModel::roleNames();
+}
+
+void SwitcherModel::sync()
+{
+    // Rows map to the source by position. Whatever the source did, the
+    // delegates of the rows both have keep their item and only get new
+    // data.
+    const int count = m_sourceModel ? m_sourceModel->rowCount() : 0;
+
+    if (count < m_count) {
+        beginRemoveRows(QModelIndex(), count, m_count - 1);
+        m_count = count;
+        endRemoveRows();
+    } else if (count > m_count) {
+        const int kept = m_count;
+        beginInsertRows(QModelIndex(), m_count, count - 1);
+        m_count = count;
+        endInsertRows();
+
+        if (kept > 0)
+            emit dataChanged(index(0), index(kept - 1));
+        return;
+    }
+
+    if (m_count > 0)
+        emit dataChanged(index(0), index(m_count - 1));
+}
@@ -0,0 +1,59 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef SWITCHERMODEL_H
+#define SWITCHERMODEL_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QtQml/qqmlregistration.h>
+
+// Presents KWin's client model to the switcher grid. KWin resets that
+// model on every open, which makes a view drop all of its delegates and
+// create them again. Here a reset turns into rows inserted or removed at
+// the end and a change of the rest, so the delegates created for one
+// open are kept for the next.
+class SwitcherModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+
+    Q_PROPERTY(QAbstractItemModel *sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged)
+
+public:
+    explicit SwitcherModel(QObject *parent = nullptr);
+
+    QAbstractItemModel *sourceModel() const { return m_sourceModel; }
+    void setSourceModel(QAbstractItemModel *model);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+signals:
+    void sourceModelChanged();
+
+private:
+    void sync();
+
+    QPointer<QAbstractItemModel> m_sourceModel;
+    int m_count = 0;
+};
+
+#endif
@@ -0,0 +1,37 @@
+/*
+    SPDX-FileCopyrightText: 2026 CutefishOS Team
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+"use strict";
+
+// Window class lists of the scripted effects, see CMakeLists.txt for how
+// this file ends up in front of each effect's main.js.
+
+// Plain entries are matched exactly, entries written as /pattern/ are
+// compiled into regular expressions once.
+function classSet(list) {
+    var set = { exact: {}, patterns: [] };
+    for (var i = 0; i < list.length; i++) {
+        var entry = String(list[i]).trim();
+        if (entry.length > 2 && entry[0] == "/" && entry[entry.length - 1] == "/") {
+            set.patterns.push(new RegExp(entry.slice(1, -1)));
+        } else if (entry.length > 0) {
+            set.exact[entry] = true;
+        }
+    }
+    return set;
+}
+
+function classSetContains(set, windowClass) {
+    if (set.exact.hasOwnProperty(windowClass)) {
+        return true;
+    }
+    for (var i = 0; i < set.patterns.length; i++) {
+        if (set.patterns[i].test(windowClass)) {
+            return true;
+        }
+    }
+    return false;
+}
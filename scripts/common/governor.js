@@ -0,0 +1,109 @@
+/*
+    SPDX-FileCopyrightText: 2026 CutefishOS Team
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+"use strict";
+
+// Animations are advanced by presentation time, so when one ends well
+// after its duration the frames around it overran. After repeated
+// overruns quality is degraded one step at a time: first the forced
+// blur goes, then durations are halved, then secondary windows are no
+// longer animated. A run of on-time animations restores one step.
+//
+// Reads Governor, GovernorOverrun and GovernorDebug from the effect's
+// config, see contents/config/main.xml of the effects. name only labels
+// the log output.
+function createGovernor(name) {
+    var governor = {
+        level: 0,
+        samples: [],
+        counters: {
+            animations: 0,
+            overruns: 0,
+            skipped: 0,
+            degraded: 0,
+            restored: 0
+        },
+        loadConfig: function () {
+            governor.enabled = effect.readConfig("Governor", true);
+            governor.overrunThreshold = effect.readConfig("GovernorOverrun", 34);
+            governor.debug = effect.readConfig("GovernorDebug", false);
+            if (!governor.enabled) {
+                governor.level = 0;
+                governor.samples = [];
+            }
+        },
+        report: function (what) {
+            console.log(name + " governor: " + what + ", level " + governor.level
+                        + ", " + JSON.stringify(governor.counters));
+        },
+        started: function (window, animation, duration) {
+            if (!animation) {
+                return;
+            }
+            window.cutefishGovernor = { animation: animation, start: Date.now(), duration: duration };
+            governor.counters.animations++;
+        },
+        cancelled: function (window) {
+            delete window.cutefishGovernor;
+        },
+        ended: function (window, animation) {
+            var started = window.cutefishGovernor;
+            if (!started || started.animation != animation) {
+                return;
+            }
+            delete window.cutefishGovernor;
+            governor.sample(Date.now() - started.start - started.duration);
+        },
+        sample: function (lateness) {
+            if (!governor.enabled) {
+                return;
+            }
+            var overrun = lateness > governor.overrunThreshold;
+            if (overrun) {
+                governor.counters.overruns++;
+            }
+            governor.samples.push(overrun);
+            if (governor.samples.length > 8) {
+                governor.samples.shift();
+            }
+            if (governor.debug) {
+                governor.report("animation ended " + lateness + " ms late");
+            }
+
+            var recent = governor.samples.slice(-4).filter(function (s) { return s; }).length;
+            if (recent >= 3 && governor.level < 3) {
+                governor.level++;
+                governor.counters.degraded++;
+                governor.samples = [];
+                governor.report("degraded");
+            } else if (governor.samples.length == 8 && governor.samples.indexOf(true) < 0
+                       && governor.level > 0) {
+                governor.level--;
+                governor.counters.restored++;
+                governor.samples = [];
+                governor.report("restored");
+            }
+        },
+        forceBlur: function () {
+            return governor.level < 1;
+        },
+        duration: function (duration) {
+            return governor.level >= 2 ? duration / 2 : duration;
+        },
+        skip: function (secondary) {
+            if (governor.level >= 3 && secondary) {
+                governor.counters.skipped++;
+                if (governor.debug) {
+                    governor.report("skipped a secondary window");
+                }
+                return true;
+            }
+            return false;
+        }
+    };
+
+    return governor;
+}
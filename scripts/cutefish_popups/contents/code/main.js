@@ -9,7 +9,9 @@
 
 "use strict";
 
-var blocklist = [
+// Defaults for the Blocklist and Allowlist entries of the
+// [Effect-cutefish_popups] group, the same format the native effects use.
+var defaultBlocklist = [
     // The logout screen has to be animated only by the logout effect.
     "ksmserver ksmserver",
     "ksmserver-logout-greeter ksmserver-logout-greeter",
@@ -18,18 +20,80 @@ var blocklist = [
     "ksplashqml ksplashqml"
 ];
 
-var allowlist = [
+var defaultAllowlist = [
     "cutefish-launcher cutefish-launcher",
     "cutefish-screenshot cutefish-screenshot"
 ];
 
+var blocklist = classSet([]);
+var allowlist = classSet([]);
+
+var governor = createGovernor("cutefish_popups");
+
+// Sweeping over a menubar or along a row of tooltips closes and opens
+// popups faster than they fade. A popup that replaces a sibling closed
+// moments ago appears at once, one that was only shown briefly goes
+// away at once, and only a few fade-outs of such popups run together.
+var churn = {
+    lastClosed: {},
+    fading: [],
+    loadConfig: function () {
+        churn.replaceWindow = effect.readConfig("ChurnReplaceWindow", 150);
+        churn.minLifetime = effect.readConfig("ChurnMinLifetime", 250);
+        churn.maxFading = effect.readConfig("ChurnMaxFading", 2);
+    },
+    // Menus and tooltips of the same application replace each other,
+    // other popups are left alone.
+    siblingKey: function (window) {
+        if (window.popupMenu || window.dropdownMenu || window.comboBox) {
+            return "menu " + window.windowClass;
+        }
+        if (window.tooltip) {
+            return "tooltip " + window.windowClass;
+        }
+        return null;
+    },
+    skipFadeIn: function (window) {
+        var key = churn.siblingKey(window);
+        if (key === null || !churn.lastClosed.hasOwnProperty(key)) {
+            return false;
+        }
+        return Date.now() - churn.lastClosed[key] <= churn.replaceWindow;
+    },
+    skipFadeOut: function (window) {
+        var key = churn.siblingKey(window);
+        if (key === null) {
+            return false;
+        }
+        churn.lastClosed[key] = Date.now();
+        return window.cutefishPopupShown !== undefined
+            && Date.now() - window.cutefishPopupShown < churn.minLifetime;
+    },
+    // Cuts the oldest fade-outs short once too many run.
+    fadeOutStarted: function (window) {
+        if (churn.siblingKey(window) === null) {
+            return;
+        }
+        churn.fading = churn.fading.filter(function (w) { return w.fadeOutAnimation; });
+        churn.fading.push(window);
+        while (churn.fading.length > churn.maxFading) {
+            cutefishPopupsEffect.dropFadeOut(churn.fading.shift());
+        }
+    },
+    ended: function (window, animation) {
+        if (window.fadeOutAnimation == animation) {
+            delete window.fadeOutAnimation;
+        }
+    }
+};
+
 function isPopupWindow(window) {
     // If the window is blocklisted, don't animate it.
-    if (blocklist.indexOf(window.windowClass) != -1) {
+    if (classSetContains(blocklist, window.windowClass)) {
         return false;
     }
 
-    if (allowlist.indexOf(window.windowClass) != -1) {
+    if (classSetContains(allowlist, window.windowClass)) {
         return true;
     }
 
@@ -76,61 +140,125 @@ var cutefishPopupsEffect = {
     loadConfig: function () {
         cutefishPopupsEffect.fadeInDuration = animationTime(100);
         cutefishPopupsEffect.fadeOutDuration = animationTime(100) * 4;
+        blocklist = classSet(effect.readConfig("Blocklist", defaultBlocklist));
+        allowlist = classSet(effect.readConfig("Allowlist", defaultAllowlist));
+        // Verdicts taken with the old lists are made again when the
+        // windows close.
+        effects.stackingOrder.forEach(function (window) {
+            delete window.cutefishPopupWindow;
+        });
+        governor.loadConfig();
+        churn.loadConfig();
+    },
+    // Everything but menus, the first to lose their fade when frames
+    // overrun.
+    isSecondaryWindow: function (window) {
+        return !(window.popupMenu || window.dropdownMenu || window.comboBox);
+    },
+    // The verdict is computed once when the window shows up.
+    isCachedPopupWindow: function (window) {
+        if (window.cutefishPopupWindow === undefined) {
+            window.cutefishPopupWindow = isPopupWindow(window);
+        }
+        return window.cutefishPopupWindow;
+    },
+    cancelFadeIn: function (window) {
+        if (window.fadeInAnimation) {
+            cancel(window.fadeInAnimation);
+            delete window.fadeInAnimation;
+            governor.cancelled(window);
+        }
+    },
+    cancelFadeOut: function (window) {
+        if (window.fadeOutAnimation) {
+            cancel(window.fadeOutAnimation);
+            delete window.fadeOutAnimation;
+            governor.cancelled(window);
+        }
+    },
+    // The closed window disappears in the next frame.
+    dropFadeOut: function (window) {
+        cutefishPopupsEffect.cancelFadeOut(window);
+        effect.ungrab(window, Effect.WindowClosedGrabRole);
     },
     slotWindowAdded: function (window) {
+        window.cutefishPopupWindow = isPopupWindow(window);
+        window.cutefishPopupShown = Date.now();
         if (effects.hasActiveFullScreenEffect) {
             return;
         }
-        if (!isPopupWindow(window)) {
+        if (!window.cutefishPopupWindow) {
             return;
         }
         if (!window.visible) {
             return;
         }
+        if (governor.skip(cutefishPopupsEffect.isSecondaryWindow(window))) {
+            return;
+        }
+        if (churn.skipFadeIn(window)) {
+            cutefishPopupsEffect.cancelFadeOut(window);
+            return;
+        }
         if (!effect.grab(window, Effect.WindowAddedGrabRole)) {
             return;
         }
+        // Popups such as tooltips are shown again while still fading out,
+        // two opacity animations would multiply.
+        cutefishPopupsEffect.cancelFadeOut(window);
+        var duration = governor.duration(cutefishPopupsEffect.fadeInDuration);
         window.fadeInAnimation = animate({
             window: window,
             curve: QEasingCurve.Linear,
-            duration: cutefishPopupsEffect.fadeInDuration,
+            duration: duration,
             type: Effect.Opacity,
             from: 0.0,
             to: 1.0
         });
+        governor.started(window, window.fadeInAnimation, duration);
     },
     slotWindowClosed: function (window) {
         if (effects.hasActiveFullScreenEffect) {
             return;
         }
-        if (!isPopupWindow(window)) {
+        if (!cutefishPopupsEffect.isCachedPopupWindow(window)) {
             return;
         }
         if (!window.visible) {
             return;
         }
+        if (governor.skip(cutefishPopupsEffect.isSecondaryWindow(window))) {
+            return;
+        }
+        if (churn.skipFadeOut(window)) {
+            // A running fade-in would keep the window around.
+            cutefishPopupsEffect.cancelFadeIn(window);
+            return;
+        }
         if (!effect.grab(window, Effect.WindowClosedGrabRole)) {
             return;
         }
+        cutefishPopupsEffect.cancelFadeIn(window);
+        var duration = governor.duration(cutefishPopupsEffect.fadeOutDuration);
         window.fadeOutAnimation = animate({
             window: window,
             curve: QEasingCurve.OutQuart,
-            duration: cutefishPopupsEffect.fadeOutDuration,
+            duration: duration,
             type: Effect.Opacity,
             from: 1.0,
             to: 0.0
         });
+        governor.started(window, window.fadeOutAnimation, duration);
+        churn.fadeOutStarted(window);
     },
     slotWindowDataChanged: function (window, role) {
         if (role == Effect.WindowAddedGrabRole) {
-            if (window.fadeInAnimation && effect.isGrabbed(window, role)) {
-                cancel(window.fadeInAnimation);
-                delete window.fadeInAnimation;
+            if (effect.isGrabbed(window, role)) {
+                cutefishPopupsEffect.cancelFadeIn(window);
             }
         } else if (role == Effect.WindowClosedGrabRole) {
-            if (window.fadeOutAnimation && effect.isGrabbed(window, role)) {
-                cancel(window.fadeOutAnimation);
-                delete window.fadeOutAnimation;
+            if (effect.isGrabbed(window, role)) {
+                cutefishPopupsEffect.cancelFadeOut(window);
             }
         }
     },
@@ -138,6 +266,8 @@ var cutefishPopupsEffect = {
         cutefishPopupsEffect.loadConfig();
 
         effect.configChanged.connect(cutefishPopupsEffect.loadConfig);
+        effect.animationEnded.connect(governor.ended);
+        effect.animationEnded.connect(churn.ended);
         effects.windowAdded.connect(cutefishPopupsEffect.slotWindowAdded);
         effects.windowClosed.connect(cutefishPopupsEffect.slotWindowClosed);
         effects.windowDataChanged.connect(cutefishPopupsEffect.slotWindowDataChanged);
@@ -10,7 +10,9 @@
 
 "use strict";
 
-var blocklist = [
+// Defaults for the Blocklist entry of the [Effect-cutefish_scale] group,
+// the same format the native effects use.
+var defaultBlocklist = [
     // The logout screen has to be animated only by the logout effect.
     "ksmserver ksmserver",
     "ksmserver-logout-greeter ksmserver-logout-greeter",
@@ -23,6 +25,8 @@ var blocklist = [
     "cutefish-screenshot cutefish-screenshot"
 ];
 
+var governor = createGovernor("cutefish_scale");
+
 var scaleEffect = {
     loadConfig: function (window) {
         var defaultDuration = 250;
@@ -32,6 +36,13 @@ var scaleEffect = {
         scaleEffect.inOpacity = 1.0;
         scaleEffect.outScale = 0.96;
         scaleEffect.outOpacity = 0.0;
+        scaleEffect.blocklist = classSet(effect.readConfig("Blocklist", defaultBlocklist));
+        // Verdicts taken with the old list are made again when the
+        // windows close.
+        effects.stackingOrder.forEach(function (window) {
+            delete window.cutefishScaleWindow;
+        });
+        governor.loadConfig();
     },
     isScaleWindow: function (window) {
         // We don't want to animate most of plasmashell's windows, yet, some
@@ -45,7 +56,7 @@ var scaleEffect = {
             return window.hasDecoration;
         }
 
-        if (blocklist.indexOf(window.windowClass) != -1) {
+        if (classSetContains(scaleEffect.blocklist, window.windowClass)) {
             return false;
         }
 
@@ -72,6 +83,9 @@ var scaleEffect = {
         return window.normalWindow || window.dialog;
     },
     setupForcedRoles: function (window) {
+        if (!governor.forceBlur()) {
+            return;
+        }
         window.setData(Effect.WindowForceBackgroundContrastRole, true);
         window.setData(Effect.WindowForceBlurRole, true);
     },
@@ -79,24 +93,41 @@ var scaleEffect = {
         window.setData(Effect.WindowForceBackgroundContrastRole, null);
         window.setData(Effect.WindowForceBlurRole, null);
     },
+    // Dialogs and other transients, the first to lose their animation
+    // when frames overrun.
+    isSecondaryWindow: function (window) {
+        return window.transient || !window.normalWindow;
+    },
+    // The verdict is computed once when the window shows up.
+    isCachedScaleWindow: function (window) {
+        if (window.cutefishScaleWindow === undefined) {
+            window.cutefishScaleWindow = scaleEffect.isScaleWindow(window);
+        }
+        return window.cutefishScaleWindow;
+    },
     slotWindowAdded: function (window) {
+        window.cutefishScaleWindow = scaleEffect.isScaleWindow(window);
         if (effects.hasActiveFullScreenEffect) {
             return;
         }
-        if (!scaleEffect.isScaleWindow(window)) {
+        if (!window.cutefishScaleWindow) {
             return;
         }
         if (!window.visible) {
             return;
         }
+        if (governor.skip(scaleEffect.isSecondaryWindow(window))) {
+            return;
+        }
         if (!effect.grab(window, Effect.WindowAddedGrabRole)) {
             return;
         }
         scaleEffect.setupForcedRoles(window);
+        var duration = governor.duration(scaleEffect.duration);
         window.scaleInAnimation = animate({
             window: window,
             curve: QEasingCurve.InOutSine,
-            duration: scaleEffect.duration,
+            duration: duration,
             animations: [
                 {
                     type: Effect.Scale,
@@ -108,29 +139,35 @@ var scaleEffect = {
                 }
             ]
         });
+        governor.started(window, window.scaleInAnimation, duration);
     },
     slotWindowClosed: function (window) {
         if (effects.hasActiveFullScreenEffect) {
             return;
         }
-        if (!scaleEffect.isScaleWindow(window)) {
+        if (!scaleEffect.isCachedScaleWindow(window)) {
             return;
         }
         if (!window.visible) {
             return;
         }
+        if (governor.skip(scaleEffect.isSecondaryWindow(window))) {
+            return;
+        }
         if (!effect.grab(window, Effect.WindowClosedGrabRole)) {
             return;
         }
         if (window.scaleInAnimation) {
             cancel(window.scaleInAnimation);
             delete window.scaleInAnimation;
+            governor.cancelled(window);
         }
         scaleEffect.setupForcedRoles(window);
+        var duration = governor.duration(scaleEffect.duration);
         window.scaleOutAnimation = animate({
             window: window,
             curve: QEasingCurve.InOutSine,
-            duration: scaleEffect.duration,
+            duration: duration,
             animations: [
                 {
                     type: Effect.Scale,
@@ -142,18 +179,21 @@ var scaleEffect = {
                 }
             ]
         });
+        governor.started(window, window.scaleOutAnimation, duration);
     },
     slotWindowDataChanged: function (window, role) {
         if (role == Effect.WindowAddedGrabRole) {
             if (window.scaleInAnimation && effect.isGrabbed(window, role)) {
                 cancel(window.scaleInAnimation);
                 delete window.scaleInAnimation;
+                governor.cancelled(window);
                 scaleEffect.cleanupForcedRoles(window);
             }
         } else if (role == Effect.WindowClosedGrabRole) {
             if (window.scaleOutAnimation && effect.isGrabbed(window, role)) {
                 cancel(window.scaleOutAnimation);
                 delete window.scaleOutAnimation;
+                governor.cancelled(window);
                 scaleEffect.cleanupForcedRoles(window);
             }
         }
@@ -163,6 +203,7 @@ var scaleEffect = {
 
         effect.configChanged.connect(scaleEffect.loadConfig);
         effect.animationEnded.connect(scaleEffect.cleanupForcedRoles);
+        effect.animationEnded.connect(governor.ended);
         effects.windowAdded.connect(scaleEffect.slotWindowAdded);
         effects.windowClosed.connect(scaleEffect.slotWindowClosed);
         effects.windowDataChanged.connect(scaleEffect.slotWindowDataChanged);
@@ -9,15 +9,85 @@
 
 "use strict";
 
+// The native effect deforms the window on the GPU, this script is only
+// the fallback for compositing backends it doesn't support.
+var nativeEffect = "kwin4_effect_cutefishsquash";
+
 var squashEffect = {
     duration: animationTime(300),
+    burstThreshold: 3,
+    burstInterval: 150,
+    recentEvents: [],
+    burstDeadline: 0,
     loadConfig: function () {
         squashEffect.duration = animationTime(300);
+        squashEffect.burstThreshold = effect.readConfig("BurstThreshold", 3);
+        squashEffect.burstInterval = effect.readConfig("BurstInterval", 150);
+    },
+    // Returns the remaining duration of the current burst, or 0 if the
+    // window should get its own animation.
+    registerEvent: function () {
+        var now = Date.now();
+        var events = squashEffect.recentEvents;
+
+        events.push(now);
+        while (events.length > 0 && now - events[0] > squashEffect.burstInterval) {
+            events.shift();
+        }
+
+        if (now < squashEffect.burstDeadline) {
+            return squashEffect.burstDeadline - now;
+        }
+        if (events.length <= squashEffect.burstThreshold) {
+            return 0;
+        }
+
+        squashEffect.burstDeadline = now + squashEffect.duration / 2;
+        return squashEffect.duration / 2;
+    },
+    // Windows in a burst only fade and shrink a bit, all of them finish
+    // at the same time no matter when they joined.
+    animateBurst: function (window, duration, minimizing) {
+        if (window.minimizeAnimation) {
+            cancel(window.minimizeAnimation);
+            delete window.minimizeAnimation;
+        }
+        if (window.unminimizeAnimation) {
+            cancel(window.unminimizeAnimation);
+            delete window.unminimizeAnimation;
+        }
+
+        var animation = animate({
+            window: window,
+            curve: QEasingCurve.OutQuad,
+            duration: duration,
+            animations: [
+                {
+                    type: Effect.Scale,
+                    from: minimizing ? 1.0 : 0.8,
+                    to: minimizing ? 0.8 : 1.0
+                },
+                {
+                    type: Effect.Opacity,
+                    from: minimizing ? 1.0 : 0.0,
+                    to: minimizing ? 0.0 : 1.0
+                }
+            ]
+        });
+
+        if (minimizing) {
+            window.minimizeAnimation = animation;
+        } else {
+            window.unminimizeAnimation = animation;
+        }
     },
     slotWindowMinimized: function (window) {
         if (effects.hasActiveFullScreenEffect) {
             return;
         }
+        if (effects.isEffectLoaded(nativeEffect)) {
+            return;
+        }
 
         // If the window doesn't have an icon in the task manager,
         // don't animate it.
@@ -26,6 +96,12 @@ var squashEffect = {
             return;
         }
 
+        var burstDuration = squashEffect.registerEvent();
+        if (burstDuration > 0) {
+            squashEffect.animateBurst(window, burstDuration, true);
+            return;
+        }
+
         if (window.unminimizeAnimation) {
             if (redirect(window.unminimizeAnimation, Effect.Backward)) {
                 return;
@@ -84,6 +160,9 @@ var squashEffect = {
         if (effects.hasActiveFullScreenEffect) {
             return;
         }
+        if (effects.isEffectLoaded(nativeEffect)) {
+            return;
+        }
 
         // If the window doesn't have an icon in the task manager,
         // don't animate it.
@@ -92,6 +171,12 @@ var squashEffect = {
             return;
         }
 
+        var burstDuration = squashEffect.registerEvent();
+        if (burstDuration > 0) {
+            squashEffect.animateBurst(window, burstDuration, false);
+            return;
+        }
+
         if (window.minimizeAnimation) {
             if (redirect(window.minimizeAnimation, Effect.Backward)) {
                 return;
@@ -147,6 +232,8 @@ var squashEffect = {
         });
     },
     init: function () {
+        squashEffect.loadConfig();
+
         effect.configChanged.connect(squashEffect.loadConfig);
         effects.windowMinimized.connect(squashEffect.slotWindowMinimized);
         effects.windowUnminimized.connect(squashEffect.slotWindowUnminimized);
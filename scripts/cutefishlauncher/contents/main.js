@@ -1,7 +1,38 @@
+// The launcher can't move or resize itself (see the "cutefish-launcher"
+// rule in kwinrulesrc), so its geometry only has to follow the screen.
+// Screen areas are cached and the geometry is only written when it
+// actually differs, one configure request per screen change.
+
+var launchers = [];
+var screenAreas = {};
+
+function screenArea(screen) {
+    var area = screenAreas[screen];
+    if (area === undefined) {
+        area = workspace.clientArea(KWin.ScreenArea, screen, 0);
+        screenAreas[screen] = area;
+    }
+    return area;
+}
+
+function sameGeometry(a, b) {
+    return a.x == b.x && a.y == b.y
+            && a.width == b.width && a.height == b.height;
+}
+
 function forceFullScreen(client) {
-    var screen = client.screen;
-    var screenGeometry = workspace.clientArea(KWin.ScreenArea, screen, 0);
-    client.geometry = screenGeometry;
+    var area = screenArea(client.screen);
+    if (sameGeometry(client.geometry, area)) {
+        return;
+    }
+    client.geometry = area;
+}
+
+function screensChanged() {
+    screenAreas = {};
+    for (var i = 0; i < launchers.length; i++) {
+        forceFullScreen(launchers[i]);
+    }
 }
 
 function setupConnection(client) {
@@ -10,15 +41,28 @@ function setupConnection(client) {
         return;
     }
 
-    forceFullScreen(client)
-    client.geometryChanged.connect(client, function () {
+    launchers.push(client);
+    forceFullScreen(client);
+    client.screenChanged.connect(client, function () {
         forceFullScreen(this);
     });
 }
 
+function removeConnection(client) {
+    var index = launchers.indexOf(client);
+    if (index != -1) {
+        launchers.splice(index, 1);
+    }
+}
+
 workspace.clientAdded.connect(setupConnection);
+workspace.clientRemoved.connect(removeConnection);
+workspace.screenResized.connect(screensChanged);
+workspace.numberScreensChanged.connect(screensChanged);
+workspace.virtualScreenGeometryChanged.connect(screensChanged);
+
 // connect all existing clients
 var clients = workspace.clientList();
 for (var i = 0; i < clients.length; i++) {
     setupConnection(clients[i]);
-}
\ No newline at end of file
+}
@@ -0,0 +1,307 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "effectharness.h"
+#include "eventlog.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJSEngine>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <limits>
+
+static QString readFile(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QStringLiteral("cannot read %1: %2").arg(path, file.errorString());
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+EffectHarness::EffectHarness(const QString &scriptsDir)
+    : m_scriptsDir(scriptsDir)
+{
+}
+
+bool EffectHarness::replay(const QString &tracePath, int iterations)
+{
+    QString error;
+    const QString traceText = readFile(tracePath, &error);
+    if (!error.isEmpty()) {
+        m_violations << error;
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(traceText.toUtf8(), &parseError);
+    if (!document.isObject()) {
+        m_violations << QStringLiteral("%1: %2").arg(tracePath, parseError.errorString());
+        return false;
+    }
+
+    return replay(document.object(), iterations);
+}
+
+bool EffectHarness::replay(const QJsonObject &trace, int iterations)
+{
+    QString error;
+    m_effectName = trace.value(QStringLiteral("effect")).toString();
+
+    const QString scriptPath = QStringLiteral("%1/%2/contents/code/main.js").arg(m_scriptsDir, m_effectName);
+    const QString script = readFile(scriptPath, &error);
+    if (!error.isEmpty()) {
+        m_violations << error;
+        return false;
+    }
+
+    if (!readSharedScripts())
+        return false;
+
+    for (int i = 0; i < iterations; ++i) {
+        if (!replayOnce(trace, script, scriptPath))
+            return false;
+
+        // Invariants only need to be reported once.
+        if (!m_violations.isEmpty())
+            break;
+    }
+
+    return m_violations.isEmpty();
+}
+
+QJsonObject EffectHarness::traceFromCapture(const QString &capturePath, const QString &effect, QString *error)
+{
+    using namespace Cutefish;
+
+    static const QList<QPair<quint32, QString>> flagProperties = {
+        { EventLog::Normal, QStringLiteral("normalWindow") },
+        { EventLog::Dialog, QStringLiteral("dialog") },
+        { EventLog::Transient, QStringLiteral("transient") },
+        { EventLog::Popup, QStringLiteral("popupWindow") },
+        { EventLog::PopupMenu, QStringLiteral("popupMenu") },
+        { EventLog::DropdownMenu, QStringLiteral("dropdownMenu") },
+        { EventLog::ComboBox, QStringLiteral("comboBox") },
+        { EventLog::Tooltip, QStringLiteral("tooltip") },
+        { EventLog::Notification, QStringLiteral("notification") },
+        { EventLog::CriticalNotification, QStringLiteral("criticalNotification") },
+        { EventLog::OnScreenDisplay, QStringLiteral("onScreenDisplay") },
+        { EventLog::Dock, QStringLiteral("dock") },
+        { EventLog::Splash, QStringLiteral("splash") },
+        { EventLog::Toolbar, QStringLiteral("toolbar") },
+        { EventLog::Utility, QStringLiteral("utility") },
+        { EventLog::Outline, QStringLiteral("outline") },
+        { EventLog::Managed, QStringLiteral("managed") },
+        { EventLog::Decorated, QStringLiteral("hasDecoration") },
+        { EventLog::X11Client, QStringLiteral("x11Client") },
+    };
+
+    auto rectObject = [](const QRect &rect) {
+        return QJsonObject {
+            { QStringLiteral("x"), rect.x() },
+            { QStringLiteral("y"), rect.y() },
+            { QStringLiteral("width"), rect.width() },
+            { QStringLiteral("height"), rect.height() },
+        };
+    };
+
+    EventLog::Reader reader;
+    if (!reader.open(capturePath)) {
+        *error = QStringLiteral("%1: %2").arg(capturePath, reader.errorString());
+        return QJsonObject();
+    }
+
+    QJsonObject windows;
+    QJsonArray events;
+
+    EventLog::Event record;
+    while (reader.next(record)) {
+        const QString id = QString::number(record.window);
+        QJsonObject event {
+            { QStringLiteral("time"), record.time / 1000.0 },
+            { QStringLiteral("window"), id },
+        };
+
+        switch (record.type) {
+        case EventLog::WindowAdded: {
+            QJsonObject window {
+                { QStringLiteral("windowClass"), record.windowClass },
+                { QStringLiteral("geometry"), rectObject(record.geometry) },
+                { QStringLiteral("iconGeometry"), rectObject(record.iconGeometry) },
+            };
+            for (const auto &flag : flagProperties)
+                window.insert(flag.second, bool(record.flags & flag.first));
+            windows.insert(id, window);
+            event.insert(QStringLiteral("type"), QStringLiteral("windowAdded"));
+            break;
+        }
+        case EventLog::WindowClosed:
+            event.insert(QStringLiteral("type"), QStringLiteral("windowClosed"));
+            break;
+        case EventLog::WindowDeleted:
+            event.insert(QStringLiteral("type"), QStringLiteral("windowDeleted"));
+            break;
+        case EventLog::WindowMinimized:
+            event.insert(QStringLiteral("type"), QStringLiteral("windowMinimized"));
+            break;
+        case EventLog::WindowUnminimized:
+            event.insert(QStringLiteral("type"), QStringLiteral("windowUnminimized"));
+            break;
+        case EventLog::WindowGeometry:
+            event.insert(QStringLiteral("type"), QStringLiteral("set"));
+            event.insert(QStringLiteral("property"), QStringLiteral("geometry"));
+            event.insert(QStringLiteral("value"), rectObject(record.geometry));
+            break;
+        default:
+            continue;
+        }
+
+        // Skip windows whose WindowAdded record predates the capture.
+        if (!windows.contains(id))
+            continue;
+
+        events.append(event);
+    }
+
+    if (!reader.errorString().isEmpty()) {
+        *error = QStringLiteral("%1: %2").arg(capturePath, reader.errorString());
+        return QJsonObject();
+    }
+
+    return QJsonObject {
+        { QStringLiteral("effect"), effect },
+        { QStringLiteral("windows"), windows },
+        { QStringLiteral("events"), events },
+    };
+}
+
+bool EffectHarness::readSharedScripts()
+{
+    m_sharedScripts.clear();
+
+    const QDir dir(m_scriptsDir + QStringLiteral("/common"));
+    const QFileInfoList files = dir.entryInfoList({ QStringLiteral("*.js") }, QDir::Files, QDir::Name);
+    for (const QFileInfo &info : files) {
+        QString error;
+        const QString source = readFile(info.absoluteFilePath(), &error);
+        if (!error.isEmpty()) {
+            m_violations << error;
+            return false;
+        }
+        m_sharedScripts.append({ info.absoluteFilePath(), source });
+    }
+
+    return true;
+}
+
+bool EffectHarness::replayOnce(const QJsonObject &trace, const QString &script, const QString &scriptPath)
+{
+    QJSEngine engine;
+    engine.installExtensions(QJSEngine::ConsoleExtension);
+
+    QString error;
+    const QString prelude = readFile(QStringLiteral(":/harness.js"), &error);
+    if (!checkError(engine.evaluate(prelude, QStringLiteral("harness.js")), QStringLiteral("harness.js")))
+        return false;
+
+    QJSValue harness = engine.globalObject().property(QStringLiteral("harness"));
+    harness.property(QStringLiteral("configure")).callWithInstance(harness, { engine.toScriptValue(trace.toVariantMap()) });
+
+    for (const auto &shared : std::as_const(m_sharedScripts)) {
+        if (!checkError(engine.evaluate(shared.second, shared.first), shared.first))
+            return false;
+    }
+
+    if (!checkError(engine.evaluate(script, QFileInfo(scriptPath).absoluteFilePath()), scriptPath))
+        return false;
+
+    QJSValue dispatch = harness.property(QStringLiteral("dispatch"));
+    QJSValue endNext = harness.property(QStringLiteral("endNext"));
+    QJSValue advance = harness.property(QStringLiteral("advance"));
+
+    QElapsedTimer timer;
+
+    // Animations that are due before an event end first, like they
+    // would in a frame presented before it.
+    auto endAnimations = [&](double time) {
+        for (;;) {
+            timer.start();
+            const QJSValue ended = endNext.callWithInstance(harness, { time });
+            const qint64 ns = timer.nsecsElapsed();
+
+            if (!checkError(ended, QStringLiteral("animationEnded")) || !ended.toBool())
+                break;
+
+            account(QStringLiteral("animationEnded"), ns);
+        }
+    };
+
+    const QJsonArray events = trace.value(QStringLiteral("events")).toArray();
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        const double time = event.value(QStringLiteral("time")).toDouble();
+
+        endAnimations(time);
+        advance.callWithInstance(harness, { time });
+
+        const QJSValue eventValue = engine.toScriptValue(event.toVariantMap());
+
+        timer.start();
+        const QJSValue result = dispatch.callWithInstance(harness, { eventValue });
+        const qint64 ns = timer.nsecsElapsed();
+
+        if (!checkError(result, event.value(QStringLiteral("type")).toString()))
+            return false;
+
+        account(event.value(QStringLiteral("type")).toString(), ns);
+    }
+
+    endAnimations(std::numeric_limits<double>::infinity());
+    harness.property(QStringLiteral("finish")).callWithInstance(harness);
+
+    m_violations << harness.property(QStringLiteral("violations")).toVariant().toStringList();
+    m_counters = harness.property(QStringLiteral("counters")).toVariant().toMap();
+
+    return true;
+}
+
+bool EffectHarness::checkError(const QJSValue &value, const QString &what)
+{
+    if (!value.isError())
+        return true;
+
+    m_violations << QStringLiteral("%1:%2: %3")
+                        .arg(what)
+                        .arg(value.property(QStringLiteral("lineNumber")).toInt())
+                        .arg(value.toString());
+    return false;
+}
+
+void EffectHarness::account(const QString &name, qint64 ns)
+{
+    Stats &stats = m_stats[name];
+    stats.count++;
+    stats.totalNs += ns;
+    stats.maxNs = qMax(stats.maxNs, ns);
+}
@@ -0,0 +1,76 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#ifndef EFFECTHARNESS_H
+#define EFFECTHARNESS_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+class QJSValue;
+
+// Replays a window event trace against one scripted effect in a plain
+// QJSEngine, see harness.js for the stand-ins of the KWin API.
+class EffectHarness
+{
+public:
+    struct Stats {
+        int count = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+    };
+
+    explicit EffectHarness(const QString &scriptsDir);
+
+    // Replays the trace iterations times, a fresh engine each time.
+    bool replay(const QString &tracePath, int iterations = 1);
+    bool replay(const QJsonObject &trace, int iterations = 1);
+
+    // Turns a capture of the recorder effect into a trace for effect.
+    // Damage and frame records have no counterpart in the scripted API
+    // and are dropped.
+    static QJsonObject traceFromCapture(const QString &capturePath, const QString &effect, QString *error);
+
+    QString effectName() const { return m_effectName; }
+    const QMap<QString, Stats> &stats() const { return m_stats; }
+    QVariantMap counters() const { return m_counters; }
+    QStringList violations() const { return m_violations; }
+
+private:
+    bool readSharedScripts();
+    bool replayOnce(const QJsonObject &trace, const QString &script, const QString &scriptPath);
+    bool checkError(const QJSValue &value, const QString &what);
+    void account(const QString &name, qint64 ns);
+
+    QString m_scriptsDir;
+    QString m_effectName;
+    // scripts/common, evaluated before every effect like the install
+    // prepends it to their main.js.
+    QList<QPair<QString, QString>> m_sharedScripts;
+    QMap<QString, Stats> m_stats;
+    QVariantMap m_counters;
+    QStringList m_violations;
+};
+
+#endif
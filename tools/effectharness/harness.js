@@ -0,0 +1,413 @@
+/*
+    Stand-ins for the API KWin gives scripted effects, evaluated before
+    the effect's main.js.
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+"use strict";
+
+// KWin advances animations by presentation time, the effect sees the
+// trace's clock instead of the wall clock.
+var harnessClock = 0;
+Date.now = function () {
+    return harnessClock;
+};
+
+var HARNESS_SELF = "harness-effect";
+var HARNESS_OTHER = "other-effect";
+
+function HarnessSignal() {
+    this.handlers = [];
+}
+
+HarnessSignal.prototype.connect = function (handler) {
+    this.handlers.push(handler);
+};
+
+HarnessSignal.prototype.disconnect = function (handler) {
+    var index = this.handlers.indexOf(handler);
+    if (index >= 0) {
+        this.handlers.splice(index, 1);
+    }
+};
+
+HarnessSignal.prototype.emit = function () {
+    var handlers = this.handlers.slice();
+    for (var i = 0; i < handlers.length; i++) {
+        handlers[i].apply(null, arguments);
+    }
+};
+
+var Effect = {
+    Forward: 0,
+    Backward: 1,
+
+    Opacity: 0,
+    Brightness: 1,
+    Saturation: 2,
+    Scale: 3,
+    Rotation: 4,
+    Position: 5,
+    Size: 6,
+    Translation: 7,
+    Clip: 8,
+    Generic: 9,
+    CrossFadePrevious: 10,
+    Shader: 11,
+    ShaderUniform: 12,
+
+    WindowAddedGrabRole: "WindowAddedGrabRole",
+    WindowClosedGrabRole: "WindowClosedGrabRole",
+    WindowMinimizedGrabRole: "WindowMinimizedGrabRole",
+    WindowUnminimizedGrabRole: "WindowUnminimizedGrabRole",
+    WindowForceBlurRole: "WindowForceBlurRole",
+    WindowForceBackgroundContrastRole: "WindowForceBackgroundContrastRole"
+};
+
+var QEasingCurve = {
+    Linear: 0,
+    InQuad: 1,
+    OutQuad: 2,
+    InOutQuad: 3,
+    OutInQuad: 4,
+    InCubic: 5,
+    OutCubic: 6,
+    InOutCubic: 7,
+    OutInCubic: 8,
+    InQuart: 9,
+    OutQuart: 10,
+    InOutQuart: 11,
+    OutInQuart: 12,
+    InQuint: 13,
+    OutQuint: 14,
+    InOutQuint: 15,
+    OutInQuint: 16,
+    InSine: 17,
+    OutSine: 18,
+    InOutSine: 19,
+    OutInSine: 20
+};
+
+var harness = {
+    config: {},
+    loadedEffects: [],
+    windows: {},
+    animations: {},
+    nextAnimationId: 1,
+    currentEvent: "",
+    grabsThisEvent: [],
+    violations: [],
+    counters: {
+        started: 0,
+        cancelled: 0,
+        redirected: 0,
+        ended: 0,
+        grabs: 0
+    },
+
+    violation: function (message) {
+        harness.violations.push("at " + harnessClock + " ms (" + harness.currentEvent + "): " + message);
+    },
+
+    configure: function (trace) {
+        harness.config = trace.config || {};
+        harness.loadedEffects = trace.loadedEffects || [];
+        var windows = trace.windows || {};
+        for (var id in windows) {
+            harness.windows[id] = harness.makeWindow(id, windows[id]);
+        }
+    },
+
+    makeWindow: function (id, spec) {
+        var window = {
+            harnessId: id,
+            windowClass: "",
+            caption: "",
+            visible: true,
+            managed: true,
+            x11Client: true,
+            hasDecoration: false,
+            normalWindow: false,
+            dialog: false,
+            utility: false,
+            transient: false,
+            popupWindow: false,
+            popupMenu: false,
+            dropdownMenu: false,
+            comboBox: false,
+            tooltip: false,
+            notification: false,
+            criticalNotification: false,
+            onScreenDisplay: false,
+            dock: false,
+            splash: false,
+            toolbar: false,
+            outline: false,
+            geometry: { x: 0, y: 0, width: 800, height: 600 },
+            iconGeometry: { x: 0, y: 0, width: 0, height: 0 },
+            harnessData: {}
+        };
+        for (var key in spec) {
+            window[key] = spec[key];
+        }
+        window.setData = function (role, value) {
+            if (value === null || value === undefined) {
+                delete window.harnessData[role];
+            } else {
+                window.harnessData[role] = value;
+            }
+            effects.windowDataChanged.emit(window, role);
+        };
+        window.data = function (role) {
+            return window.harnessData.hasOwnProperty(role) ? window.harnessData[role] : null;
+        };
+        return window;
+    },
+
+    liveAnimations: function (window) {
+        var result = [];
+        for (var id in harness.animations) {
+            if (harness.animations[id].window === window) {
+                result.push(harness.animations[id]);
+            }
+        }
+        return result;
+    },
+
+    // KWin drops the grabs of an effect once it no longer animates the
+    // window.
+    releaseGrabs: function (window) {
+        if (harness.liveAnimations(window).length > 0) {
+            return;
+        }
+        for (var role in window.harnessData) {
+            if (window.harnessData[role] === HARNESS_SELF) {
+                window.setData(role, null);
+            }
+        }
+    },
+
+    dispatch: function (event) {
+        harness.currentEvent = event.type + (event.window !== undefined ? " " + event.window : "");
+        harness.grabsThisEvent = [];
+
+        var window = harness.windows[event.window];
+        if (event.window !== undefined && !window) {
+            harness.violation("unknown window in trace");
+            return;
+        }
+
+        try {
+            switch (event.type) {
+            case "windowAdded":
+                effects.windowAdded.emit(window);
+                break;
+            case "windowClosed":
+                effects.windowClosed.emit(window);
+                break;
+            case "windowMinimized":
+                effects.windowMinimized.emit(window);
+                break;
+            case "windowUnminimized":
+                effects.windowUnminimized.emit(window);
+                break;
+            case "windowDeleted":
+                for (var id in harness.animations) {
+                    if (harness.animations[id].window === window) {
+                        delete harness.animations[id];
+                    }
+                }
+                effects.windowDeleted.emit(window);
+                delete harness.windows[event.window];
+                break;
+            case "externalGrab":
+                window.setData(Effect[event.role], HARNESS_OTHER);
+                break;
+            case "set":
+                window[event.property] = event.value;
+                break;
+            case "configChanged":
+                for (var key in event.config) {
+                    harness.config[key] = event.config[key];
+                }
+                effect.configChanged.emit();
+                break;
+            default:
+                harness.violation("unknown event type");
+                return;
+            }
+        } catch (error) {
+            harness.violation("uncaught exception: " + error + (error.stack ? "\n" + error.stack : ""));
+        }
+
+        // A grab is only released when an animation on the window ends,
+        // taking one without animating keeps the window forever.
+        for (var i = 0; i < harness.grabsThisEvent.length; i++) {
+            var grab = harness.grabsThisEvent[i];
+            if (grab.window.data(grab.role) === HARNESS_SELF
+                    && harness.liveAnimations(grab.window).length == 0) {
+                harness.violation("leaked " + grab.role + " on window " + grab.window.harnessId);
+                grab.window.setData(grab.role, null);
+            }
+        }
+    },
+
+    // Ends the earliest animation due at time, returns false when there
+    // is none.
+    endNext: function (time) {
+        var next = null;
+        for (var id in harness.animations) {
+            var animation = harness.animations[id];
+            if (animation.end <= time && (!next || animation.end < next.end)) {
+                next = animation;
+            }
+        }
+        if (!next) {
+            return false;
+        }
+
+        harnessClock = Math.max(harnessClock, next.end);
+        harness.currentEvent = "animationEnded " + next.window.harnessId;
+        delete harness.animations[next.id];
+        harness.counters.ended++;
+
+        try {
+            effect.animationEnded.emit(next.window, next.id);
+        } catch (error) {
+            harness.violation("uncaught exception: " + error);
+        }
+        harness.releaseGrabs(next.window);
+        return true;
+    },
+
+    advance: function (time) {
+        harnessClock = Math.max(harnessClock, time);
+    },
+
+    finish: function () {
+        harness.currentEvent = "end of trace";
+        for (var id in harness.windows) {
+            var window = harness.windows[id];
+            if (window.data(Effect.WindowForceBlurRole) !== null
+                    || window.data(Effect.WindowForceBackgroundContrastRole) !== null) {
+                harness.violation("forced blur/contrast left set on window " + id);
+            }
+        }
+    }
+};
+
+var effects = {
+    hasActiveFullScreenEffect: false,
+    get stackingOrder() {
+        var windows = [];
+        for (var id in harness.windows) {
+            windows.push(harness.windows[id]);
+        }
+        return windows;
+    },
+    windowAdded: new HarnessSignal(),
+    windowClosed: new HarnessSignal(),
+    windowDeleted: new HarnessSignal(),
+    windowMinimized: new HarnessSignal(),
+    windowUnminimized: new HarnessSignal(),
+    windowDataChanged: new HarnessSignal(),
+    isEffectLoaded: function (name) {
+        return harness.loadedEffects.indexOf(name) >= 0;
+    }
+};
+
+var effect = {
+    configChanged: new HarnessSignal(),
+    animationEnded: new HarnessSignal(),
+    readConfig: function (key, defaultValue) {
+        return harness.config.hasOwnProperty(key) ? harness.config[key] : defaultValue;
+    },
+    grab: function (window, role) {
+        var grabber = window.data(role);
+        if (grabber !== null && grabber !== HARNESS_SELF) {
+            return false;
+        }
+        window.setData(role, HARNESS_SELF);
+        harness.grabsThisEvent.push({ window: window, role: role });
+        harness.counters.grabs++;
+        return true;
+    },
+    ungrab: function (window, role) {
+        if (window.data(role) !== HARNESS_SELF) {
+            return false;
+        }
+        window.setData(role, null);
+        return true;
+    },
+    isGrabbed: function (window, role) {
+        var grabber = window.data(role);
+        return grabber !== null && grabber !== HARNESS_SELF;
+    }
+};
+
+function animationTime(duration) {
+    return duration;
+}
+
+function animate(settings) {
+    var types = [];
+    if (settings.animations) {
+        for (var i = 0; i < settings.animations.length; i++) {
+            types.push(settings.animations[i].type);
+        }
+    } else {
+        types.push(settings.type);
+    }
+
+    var window = settings.window;
+    var live = harness.liveAnimations(window);
+    for (var j = 0; j < live.length; j++) {
+        for (var k = 0; k < types.length; k++) {
+            if (live[j].types.indexOf(types[k]) >= 0) {
+                harness.violation("animation " + live[j].id + " still runs the same attribute on window "
+                                  + window.harnessId + ", they would stack");
+                break;
+            }
+        }
+    }
+
+    var duration = settings.duration || 0;
+    var animation = {
+        id: harness.nextAnimationId++,
+        window: window,
+        types: types,
+        start: harnessClock,
+        duration: duration,
+        end: harnessClock + duration + (settings.delay || 0),
+        direction: Effect.Forward
+    };
+    harness.animations[animation.id] = animation;
+    harness.counters.started++;
+    return animation.id;
+}
+
+function cancel(id) {
+    if (!harness.animations[id]) {
+        return false;
+    }
+    delete harness.animations[id];
+    harness.counters.cancelled++;
+    return true;
+}
+
+function redirect(id, direction) {
+    var animation = harness.animations[id];
+    if (!animation) {
+        return false;
+    }
+    if (animation.direction != direction) {
+        // Play back the part that already ran.
+        var elapsed = Math.min(harnessClock - animation.start, animation.duration);
+        animation.start = harnessClock - (animation.duration - elapsed);
+        animation.end = harnessClock + elapsed;
+        animation.direction = direction;
+    }
+    harness.counters.redirected++;
+    return true;
+}
@@ -0,0 +1,129 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+#include "effectharness.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replays window event traces against the scripted effects."));
+    parser.addHelpOption();
+    parser.addOption({ QStringLiteral("scripts"), QStringLiteral("Directory containing the effect packages."),
+                       QStringLiteral("dir"), QStringLiteral(CUTEFISH_SCRIPTS_DIR) });
+    parser.addOption({ QStringLiteral("iterations"), QStringLiteral("Replay every trace this many times."),
+                       QStringLiteral("n"), QStringLiteral("1") });
+    parser.addOption({ QStringLiteral("effect"), QStringLiteral("Effect to replay captures against, all of them if omitted."),
+                       QStringLiteral("name") });
+    parser.addPositionalArgument(QStringLiteral("traces"),
+                                 QStringLiteral("Trace files or captures of the recorder effect, all bundled traces if omitted."),
+                                 QStringLiteral("[trace.json|capture.bin...]"));
+    parser.process(app);
+
+    const QString scriptsDir = parser.value(QStringLiteral("scripts"));
+
+    QStringList traces = parser.positionalArguments();
+    if (traces.isEmpty()) {
+        const QDir dir(QStringLiteral(CUTEFISH_TRACES_DIR));
+        for (const QString &name : dir.entryList({ QStringLiteral("*.json") }, QDir::Files, QDir::Name))
+            traces << dir.filePath(name);
+    }
+
+    const int iterations = qMax(1, parser.value(QStringLiteral("iterations")).toInt());
+    QTextStream out(stdout);
+    int failures = 0;
+
+    QStringList captureEffects;
+    if (parser.isSet(QStringLiteral("effect"))) {
+        captureEffects << parser.value(QStringLiteral("effect"));
+    } else {
+        const QDir dir(scriptsDir);
+        for (const QString &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+            if (QFileInfo::exists(dir.filePath(name + QStringLiteral("/contents/code/main.js"))))
+                captureEffects << name;
+        }
+    }
+
+    auto report = [&](EffectHarness &harness, const QString &trace, bool ok) {
+        out << harness.effectName() << ": " << QFileInfo(trace).fileName()
+            << " (" << iterations << (iterations == 1 ? " iteration" : " iterations") << ")\n";
+        out << QStringLiteral("  %1 %2 %3 %4\n")
+                   .arg(QStringLiteral("event"), -20)
+                   .arg(QStringLiteral("count"), 7)
+                   .arg(QStringLiteral("mean us"), 10)
+                   .arg(QStringLiteral("max us"), 10);
+
+        const auto &stats = harness.stats();
+        for (auto it = stats.cbegin(); it != stats.cend(); ++it) {
+            out << QStringLiteral("  %1 %2 %3 %4\n")
+                       .arg(it.key(), -20)
+                       .arg(it->count, 7)
+                       .arg(it->totalNs / 1000.0 / it->count, 10, 'f', 1)
+                       .arg(it->maxNs / 1000.0, 10, 'f', 1);
+        }
+
+        const QVariantMap counters = harness.counters();
+        out << "  animations: " << counters.value(QStringLiteral("started")).toInt() << " started, "
+            << counters.value(QStringLiteral("cancelled")).toInt() << " cancelled, "
+            << counters.value(QStringLiteral("redirected")).toInt() << " redirected, "
+            << counters.value(QStringLiteral("ended")).toInt() << " ended, "
+            << counters.value(QStringLiteral("grabs")).toInt() << " grabs\n";
+
+        if (ok) {
+            out << "  OK\n\n";
+        } else {
+            ++failures;
+            out << "  FAIL\n";
+            for (const QString &violation : harness.violations())
+                out << "    " << violation << '\n';
+            out << '\n';
+        }
+    };
+
+    for (const QString &trace : std::as_const(traces)) {
+        if (trace.endsWith(QLatin1String(".json"))) {
+            EffectHarness harness(scriptsDir);
+            report(harness, trace, harness.replay(trace, iterations));
+            continue;
+        }
+
+        for (const QString &effect : std::as_const(captureEffects)) {
+            QString error;
+            const QJsonObject converted = EffectHarness::traceFromCapture(trace, effect, &error);
+            if (!error.isEmpty()) {
+                out << error << "\n\n";
+                ++failures;
+                break;
+            }
+
+            EffectHarness harness(scriptsDir);
+            report(harness, trace, harness.replay(converted, iterations));
+        }
+    }
+
+    out.flush();
+    return failures ? 1 : 0;
+}
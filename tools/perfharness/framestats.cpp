@@ -0,0 +1,163 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+// Frame interval percentiles of recorder captures, compared against an
+// earlier run when --baseline is given.
+
+#include "eventlog.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Cutefish;
+
+static qint64 percentile(const QVector<qint64> &sorted, int p)
+{
+    // Nearest rank, always one of the measured frames.
+    const int rank = int(std::ceil(p / 100.0 * sorted.size()));
+    return sorted.at(qBound(0, rank - 1, int(sorted.size()) - 1));
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Prints frame interval percentiles of recorder captures."));
+    parser.addHelpOption();
+    parser.addOption({ QStringLiteral("warmup"), QStringLiteral("Ignore frames in the first ms of every capture."),
+                       QStringLiteral("ms"), QStringLiteral("1000") });
+    parser.addOption({ QStringLiteral("idle"), QStringLiteral("Ignore frames presented more than this many ms after the previous one, nothing was painted in between."),
+                       QStringLiteral("ms"), QStringLiteral("250") });
+    parser.addOption({ QStringLiteral("json"), QStringLiteral("Also write the results to this file."),
+                       QStringLiteral("file") });
+    parser.addOption({ QStringLiteral("baseline"), QStringLiteral("Earlier --json output to compare against."),
+                       QStringLiteral("file") });
+    parser.addOption({ QStringLiteral("tolerance"), QStringLiteral("Allowed p50 and p99 increase over the baseline in percent."),
+                       QStringLiteral("percent"), QStringLiteral("10") });
+    parser.addPositionalArgument(QStringLiteral("captures"),
+                                 QStringLiteral("Captures of the recorder effect, named after their scenario."),
+                                 QStringLiteral("capture.bin..."));
+    parser.process(app);
+
+    const QStringList captures = parser.positionalArguments();
+    if (captures.isEmpty())
+        parser.showHelp(1);
+
+    const qint64 warmup = parser.value(QStringLiteral("warmup")).toLongLong() * 1000;
+    const qint64 idle = parser.value(QStringLiteral("idle")).toLongLong() * 1000;
+    const qreal tolerance = 1.0 + parser.value(QStringLiteral("tolerance")).toDouble() / 100.0;
+
+    QJsonObject baseline;
+    if (parser.isSet(QStringLiteral("baseline"))) {
+        QFile file(parser.value(QStringLiteral("baseline")));
+        if (file.open(QIODevice::ReadOnly))
+            baseline = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    QTextStream out(stdout);
+    QJsonObject results;
+    int failures = 0;
+
+    out << QStringLiteral("%1 %2 %3 %4 %5 %6 %7\n")
+               .arg(QStringLiteral("scenario"), -20)
+               .arg(QStringLiteral("frames"), 7)
+               .arg(QStringLiteral("mean us"), 9)
+               .arg(QStringLiteral("p50 us"), 9)
+               .arg(QStringLiteral("p90 us"), 9)
+               .arg(QStringLiteral("p99 us"), 9)
+               .arg(QStringLiteral("max us"), 9);
+
+    for (const QString &capture : captures) {
+        const QString name = QFileInfo(capture).completeBaseName();
+
+        EventLog::Reader reader;
+        if (!reader.open(capture)) {
+            out << name << ": " << reader.errorString() << '\n';
+            ++failures;
+            continue;
+        }
+
+        QVector<qint64> frames;
+        qint64 total = 0;
+        EventLog::Event event;
+        while (reader.next(event)) {
+            if (event.type != EventLog::Frame || event.time < warmup || qint64(event.value) > idle)
+                continue;
+            frames.append(qint64(event.value));
+            total += qint64(event.value);
+        }
+
+        if (!reader.errorString().isEmpty() || frames.isEmpty()) {
+            out << name << ": " << (frames.isEmpty() ? QStringLiteral("no frames") : reader.errorString()) << '\n';
+            ++failures;
+            continue;
+        }
+
+        std::sort(frames.begin(), frames.end());
+
+        QJsonObject result;
+        result[QStringLiteral("frames")] = frames.size();
+        result[QStringLiteral("mean")] = qreal(total) / frames.size();
+        result[QStringLiteral("p50")] = percentile(frames, 50);
+        result[QStringLiteral("p90")] = percentile(frames, 90);
+        result[QStringLiteral("p99")] = percentile(frames, 99);
+        result[QStringLiteral("max")] = frames.last();
+        results[name] = result;
+
+        out << QStringLiteral("%1 %2 %3 %4 %5 %6 %7\n")
+                   .arg(name, -20)
+                   .arg(frames.size(), 7)
+                   .arg(result[QStringLiteral("mean")].toDouble(), 9, 'f', 1)
+                   .arg(percentile(frames, 50), 9)
+                   .arg(percentile(frames, 90), 9)
+                   .arg(percentile(frames, 99), 9)
+                   .arg(frames.last(), 9);
+
+        const QJsonObject previous = baseline.value(name).toObject();
+        for (const QString &key : { QStringLiteral("p50"), QStringLiteral("p99") }) {
+            if (!previous.contains(key))
+                continue;
+
+            const qreal before = previous.value(key).toDouble();
+            const qreal now = result.value(key).toDouble();
+            if (now > before * tolerance) {
+                out << "  REGRESSION " << key << ' ' << before << " us -> " << now << " us\n";
+                ++failures;
+            }
+        }
+    }
+
+    if (parser.isSet(QStringLiteral("json"))) {
+        QFile file(parser.value(QStringLiteral("json")));
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            file.write(QJsonDocument(results).toJson());
+    }
+
+    out.flush();
+    return failures ? 1 : 0;
+}
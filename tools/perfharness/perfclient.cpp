@@ -0,0 +1,158 @@
+/*
+ *   Copyright © 2026 CutefishOS Team.
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *   General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; see the file COPYING.  if not, write to
+ *   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ *   Boston, MA 02110-1301, USA.
+ */
+
+// Synthetic client for run-perf.sh. Every scenario opens plain
+// decorated windows and drives them with a timer until --duration is
+// over, the compositor side is measured by the recorder effect.
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QMenu>
+#include <QTextStream>
+#include <QTimer>
+#include <QToolTip>
+#include <QWidget>
+
+#include <cmath>
+
+static QWidget *createWindow(int index, const QSize &size)
+{
+    QWidget *window = new QWidget;
+    window->setWindowTitle(QStringLiteral("perfclient %1").arg(index));
+    window->setAutoFillBackground(true);
+
+    QPalette palette = window->palette();
+    palette.setColor(QPalette::Window, QColor::fromHsv((index * 47) % 360, 60, 235));
+    window->setPalette(palette);
+
+    // Placement is up to kwin on Wayland, this only spreads them on X11.
+    window->resize(size);
+    window->move(40 + (index % 10) * 60, 40 + (index % 10) * 40);
+    window->show();
+
+    return window;
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Opens synthetic windows for the compositor performance harness."));
+    parser.addHelpOption();
+    parser.addOption({ QStringLiteral("scenario"),
+                       QStringLiteral("static-windows, resize-storm, menu-burst or minimize-all."),
+                       QStringLiteral("name"), QStringLiteral("static-windows") });
+    parser.addOption({ QStringLiteral("count"), QStringLiteral("Number of windows."),
+                       QStringLiteral("n"), QStringLiteral("20") });
+    parser.addOption({ QStringLiteral("duration"), QStringLiteral("Seconds to run before exiting."),
+                       QStringLiteral("s"), QStringLiteral("10") });
+    parser.addOption({ QStringLiteral("interval"), QStringLiteral("Milliseconds between steps, a per scenario default if omitted."),
+                       QStringLiteral("ms") });
+    parser.process(app);
+
+    const QString scenario = parser.value(QStringLiteral("scenario"));
+    const int count = qMax(1, parser.value(QStringLiteral("count")).toInt());
+    const int duration = qMax(1, parser.value(QStringLiteral("duration")).toInt());
+
+    int interval = parser.value(QStringLiteral("interval")).toInt();
+    if (interval <= 0) {
+        if (scenario == QLatin1String("resize-storm"))
+            interval = 16;
+        else if (scenario == QLatin1String("menu-burst"))
+            interval = 120;
+        else
+            interval = 1000;
+    }
+
+    QList<QWidget *> windows;
+    QTimer timer;
+    timer.setInterval(interval);
+    int step = 0;
+
+    if (scenario == QLatin1String("static-windows")) {
+        for (int i = 0; i < count; ++i)
+            windows << createWindow(i, QSize(640, 480));
+    } else if (scenario == QLatin1String("resize-storm")) {
+        for (int i = 0; i < count; ++i)
+            windows << createWindow(i, QSize(640, 480));
+
+        // Every window resizes every step, out of phase with the others
+        // so that the damage never lines up.
+        QObject::connect(&timer, &QTimer::timeout, [&] {
+            ++step;
+            for (int i = 0; i < windows.size(); ++i) {
+                const qreal phase = step * 0.15 + i * 0.7;
+                windows.at(i)->resize(480 + int(200 * std::sin(phase)), 360 + int(150 * std::cos(phase)));
+            }
+        });
+    } else if (scenario == QLatin1String("menu-burst")) {
+        QWidget *window = createWindow(0, QSize(800, 600));
+        windows << window;
+
+        QMenu *menu = new QMenu(window);
+        for (int i = 0; i < 12; ++i)
+            menu->addAction(QStringLiteral("Action %1").arg(i));
+        QMenu *submenu = menu->addMenu(QStringLiteral("More"));
+        for (int i = 0; i < 6; ++i)
+            submenu->addAction(QStringLiteral("Item %1").arg(i));
+
+        // A menu or a tooltip opens or closes every step, like sweeping
+        // over a menu bar.
+        QObject::connect(&timer, &QTimer::timeout, [=, &step] {
+            ++step;
+            const QPoint pos(40 + (step % 8) * 80, 30);
+
+            if (menu->isVisible()) {
+                menu->hide();
+                QToolTip::showText(window->mapToGlobal(pos), QStringLiteral("Tooltip %1").arg(step), window);
+            } else {
+                QToolTip::hideText();
+                menu->popup(window->mapToGlobal(pos));
+            }
+        });
+    } else if (scenario == QLatin1String("minimize-all")) {
+        for (int i = 0; i < count; ++i)
+            windows << createWindow(i, QSize(640, 480));
+
+        QObject::connect(&timer, &QTimer::timeout, [&] {
+            const bool minimize = (++step % 2) == 1;
+            for (QWidget *window : std::as_const(windows)) {
+                if (minimize) {
+                    window->showMinimized();
+                } else {
+                    // A Wayland client cannot unminimize itself, map the
+                    // window again instead.
+                    window->hide();
+                    window->showNormal();
+                }
+            }
+        });
+    } else {
+        QTextStream(stderr) << "Unknown scenario " << scenario << '\n';
+        return 1;
+    }
+
+    timer.start();
+    QTimer::singleShot(duration * 1000, &app, &QCoreApplication::quit);
+
+    const int ret = app.exec();
+    qDeleteAll(windows);
+    return ret;
+}
@@ -0,0 +1,129 @@
+#!/bin/sh
+#
+# Installs the build into a temporary prefix, then runs every scenario of
+# perfclient in its own nested kwin_wayland on a virtual output with
+# software rendering. The recorder effect writes one capture per scenario
+# and framestats prints their frame interval percentiles.
+#
+#   run-perf.sh --build-dir DIR --client PERFCLIENT --framestats FRAMESTATS
+#               [--output DIR] [--baseline FILE] [--scenarios "a b"]
+#               [--count N] [--duration S]
+
+set -e
+
+build_dir=
+client=
+framestats=
+output=
+baseline=
+scenarios="static-windows resize-storm menu-burst minimize-all"
+count=20
+duration=10
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --build-dir) build_dir=$2; shift 2 ;;
+        --client) client=$2; shift 2 ;;
+        --framestats) framestats=$2; shift 2 ;;
+        --output) output=$2; shift 2 ;;
+        --baseline) baseline=$2; shift 2 ;;
+        --scenarios) scenarios=$2; shift 2 ;;
+        --count) count=$2; shift 2 ;;
+        --duration) duration=$2; shift 2 ;;
+        *) echo "Unknown option $1" >&2; exit 2 ;;
+    esac
+done
+
+if [ -z "$build_dir" ] || [ -z "$client" ] || [ -z "$framestats" ]; then
+    echo "--build-dir, --client and --framestats are required" >&2
+    exit 2
+fi
+
+if ! command -v kwin_wayland >/dev/null; then
+    echo "kwin_wayland not found" >&2
+    exit 2
+fi
+
+work=$(mktemp -d)
+kwin_pid=
+trap 'kill $kwin_pid 2>/dev/null || true; rm -rf "$work"' EXIT
+
+output=${output:-$PWD/perf}
+mkdir -p "$output"
+
+# The install paths are absolute, so stage them under DESTDIR and point
+# Qt and kwin at the staged copies.
+DESTDIR="$work/root" cmake --install "$build_dir" >/dev/null
+
+decoration_dir=$(find "$work/root" -type d -name org.kde.kdecoration2 | head -n 1)
+if [ -z "$decoration_dir" ]; then
+    echo "The decoration is not built in $build_dir" >&2
+    exit 2
+fi
+plugin_path=${decoration_dir%/org.kde.kdecoration2}
+
+export QT_PLUGIN_PATH="$plugin_path${QT_PLUGIN_PATH:+:$QT_PLUGIN_PATH}"
+export XDG_DATA_DIRS="$work/root/usr/share:${XDG_DATA_DIRS:-/usr/local/share:/usr/share}"
+export XDG_CONFIG_DIRS="$work/root/etc/xdg:${XDG_CONFIG_DIRS:-/etc/xdg}"
+export XDG_CONFIG_HOME="$work/config"
+export XDG_CACHE_HOME="$work/cache"
+export XDG_CURRENT_DESKTOP=Cutefish
+export LIBGL_ALWAYS_SOFTWARE=1
+export KWIN_COMPOSE=O2
+mkdir -p "$XDG_CONFIG_HOME"
+
+captures=
+status=0
+
+for scenario in $scenarios; do
+    capture="$output/$scenario.bin"
+    rm -f "$capture"
+
+    cat > "$XDG_CONFIG_HOME/kwinrc" <<EOF
+[Plugins]
+kwin4_effect_roundedwindowEnabled=true
+kwin4_effect_cutefishsquashEnabled=true
+kwin4_effect_cutefishrecorderEnabled=true
+cutefish_popupsEnabled=true
+cutefish_scaleEnabled=true
+
+[Effect-cutefishrecorder]
+Path=$capture
+
+[org.kde.kdecoration2]
+library=org.cutefish.decoration
+EOF
+
+    socket="cutefish-perf-$$"
+    kwin_wayland --virtual --width 1920 --height 1080 --socket "$socket" \
+        --no-lockscreen --no-global-shortcuts > "$work/kwin-$scenario.log" 2>&1 &
+    kwin_pid=$!
+
+    # Wait for the compositor to accept clients.
+    tries=0
+    while [ ! -S "${XDG_RUNTIME_DIR:-/tmp}/$socket" ]; do
+        tries=$((tries + 1))
+        if [ $tries -gt 100 ] || ! kill -0 $kwin_pid 2>/dev/null; then
+            echo "$scenario: kwin_wayland did not start, see its log:" >&2
+            cat "$work/kwin-$scenario.log" >&2
+            exit 1
+        fi
+        sleep 0.1
+    done
+
+    echo "$scenario: $count windows for ${duration}s"
+    WAYLAND_DISPLAY="$socket" QT_QPA_PLATFORM=wayland \
+        "$client" --scenario "$scenario" --count "$count" --duration "$duration" || status=1
+
+    kill $kwin_pid
+    wait $kwin_pid 2>/dev/null || true
+    kwin_pid=
+
+    captures="$captures $capture"
+done
+
+# shellcheck disable=SC2086
+"$framestats" --json "$output/framestats.json" ${baseline:+--baseline "$baseline"} $captures || status=1
+
+echo "Results written to $output/framestats.json"
+exit $status